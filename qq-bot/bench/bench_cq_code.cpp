@@ -0,0 +1,75 @@
+﻿// CQ 码处理：旧版各处零散查找并拷贝子串 vs 单趟切分为段视图（不拷贝）
+// 每条群消息做一次 @机器人 判断与正文截取、一次 +1 计数键计算，与处理链中的实际用法一致
+#include "bench_frames.h"
+#include "config.h"
+#include "cq_code.h"
+#include "group_message_event.h"
+#include "legacy_cq.h"
+#include "utf8.h"
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+const std::vector<std::string>& raw_messages() {
+    static const std::vector<std::string> msgs = [] {
+        std::vector<std::string> v;
+        for (const auto& f : bench_frames()) {
+            GroupMessageEvent ev;
+            if (!utf8_is_valid(f) || f.find("\"message_type\":\"group\"") == std::string::npos) continue;
+            if (decode_group_message_event(f, ev) && ev.has_raw_message) v.push_back(ev.raw_message);
+        }
+        return v;
+    }();
+    return msgs;
+}
+
+size_t total_bytes() {
+    size_t n = 0;
+    for (const auto& m : raw_messages()) n += m.size();
+    return n;
+}
+
+void BM_CqScan_Legacy(benchmark::State& state) {
+    const auto& msgs = raw_messages();
+    for (auto _ : state) {
+        for (const auto& m : msgs) {
+            benchmark::DoNotOptimize(legacy::strip_at_bot(m));
+            benchmark::DoNotOptimize(legacy::plusone_key(m));
+        }
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * total_bytes()));
+}
+
+void BM_CqScan_Tokenizer(benchmark::State& state) {
+    const auto& msgs = raw_messages();
+    std::vector<CqSegment> segs;
+    std::string key;
+    for (auto _ : state) {
+        for (const auto& m : msgs) {
+            cq_tokenize(m, segs);
+            std::string_view body = m;
+            for (const auto& s : segs) {
+                if (s.type == CqType::At && s.value == BOT_QQ) {
+                    body = std::string_view(m).substr(static_cast<size_t>(s.raw.data() - m.data()) + s.raw.size());
+                    break;
+                }
+            }
+            benchmark::DoNotOptimize(body.data());
+            key.clear();
+            if (!segs.empty() && segs.front().type == CqType::Image) {
+                key.append("img:").append(segs.front().value);
+            } else {
+                key.append("txt:").append(m);
+            }
+            benchmark::DoNotOptimize(key.data());
+        }
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * total_bytes()));
+}
+
+} // namespace
+
+BENCHMARK(BM_CqScan_Legacy);
+BENCHMARK(BM_CqScan_Tokenizer);
@@ -0,0 +1,44 @@
+﻿#include "bench_frames.h"
+#include <cstdlib>
+#include <cstdio>
+#include <fstream>
+
+namespace {
+
+std::vector<std::string> load_frames() {
+    std::vector<std::string> frames;
+    std::vector<std::string> candidates;
+    if (const char* env = std::getenv("QQBOT_BENCH_FRAMES")) candidates.push_back(env);
+    candidates.push_back("data/sample_frames.jsonl");
+    candidates.push_back("bench/data/sample_frames.jsonl");
+    for (const auto& path : candidates) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) continue;
+        std::string line;
+        while (std::getline(in, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (!line.empty()) frames.push_back(line);
+        }
+        if (!frames.empty()) return frames;
+    }
+    std::fprintf(stderr, "bench: no frame samples found (set QQBOT_BENCH_FRAMES)\n");
+    std::exit(1);
+}
+
+} // namespace
+
+const std::vector<std::string>& bench_frames()
+{
+    static const std::vector<std::string> frames = load_frames();
+    return frames;
+}
+
+size_t bench_frames_bytes()
+{
+    static const size_t total = [] {
+        size_t n = 0;
+        for (const auto& f : bench_frames()) n += f.size();
+        return n;
+    }();
+    return total;
+}
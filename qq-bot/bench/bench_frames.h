@@ -0,0 +1,10 @@
+﻿#pragma once
+#include <string>
+#include <vector>
+
+// 录制的 OneBot 帧样本（每行一帧，原始字节，可能含 GBK 帧）
+// 默认读取 data/sample_frames.jsonl，可用环境变量 QQBOT_BENCH_FRAMES 指定其他录制文件
+const std::vector<std::string>& bench_frames();
+
+// 全部样本的字节数，用于 SetBytesProcessed
+size_t bench_frames_bytes();
@@ -0,0 +1,93 @@
+﻿// GBK <-> UTF-8：查表直接转换 vs 旧版 Win32（经 UTF-16 中转，每次调用四次分配）
+// 输入为录制帧样本（UTF-8）及其 GBK 编码版本，相当于日志行与旧版 NapCat 推送的 GBK 帧
+#include "bench_frames.h"
+#include "gbk_codec.h"
+#include "legacy_gbk_win32.h"
+#include "utf8.h"
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Corpus {
+    std::vector<std::string> utf8;
+    std::vector<std::string> gbk;
+    size_t utf8_bytes = 0;
+    size_t gbk_bytes = 0;
+};
+
+const Corpus& corpus() {
+    static const Corpus c = [] {
+        Corpus c;
+        for (const auto& f : bench_frames()) {
+            if (!utf8_is_valid(f)) {
+                c.gbk.push_back(f); // 录制中本来就是 GBK 的帧
+                continue;
+            }
+            c.utf8.push_back(f);
+            std::string g(utf8_to_gbk_max_len(f.size()), '\0');
+            g.resize(utf8_to_gbk_into(f.data(), f.size(), &g[0], g.size()).written);
+            c.gbk.push_back(g);
+        }
+        for (const auto& s : c.utf8) c.utf8_bytes += s.size();
+        for (const auto& s : c.gbk) c.gbk_bytes += s.size();
+        return c;
+    }();
+    return c;
+}
+
+void BM_GbkToUtf8_Table(benchmark::State& state) {
+    const Corpus& c = corpus();
+    std::vector<char> out;
+    for (auto _ : state) {
+        for (const auto& s : c.gbk) {
+            out.resize(gbk_to_utf8_max_len(s.size()));
+            benchmark::DoNotOptimize(gbk_to_utf8_into(s.data(), s.size(), out.data(), out.size()));
+        }
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * c.gbk_bytes));
+}
+
+void BM_Utf8ToGbk_Table(benchmark::State& state) {
+    const Corpus& c = corpus();
+    std::vector<char> out;
+    for (auto _ : state) {
+        for (const auto& s : c.utf8) {
+            out.resize(utf8_to_gbk_max_len(s.size()));
+            benchmark::DoNotOptimize(utf8_to_gbk_into(s.data(), s.size(), out.data(), out.size()));
+        }
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * c.utf8_bytes));
+}
+
+#ifdef _WIN32
+void BM_GbkToUtf8_Win32(benchmark::State& state) {
+    const Corpus& c = corpus();
+    for (auto _ : state) {
+        for (const auto& s : c.gbk) {
+            benchmark::DoNotOptimize(legacy::win32_gbk_to_utf8(s));
+        }
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * c.gbk_bytes));
+}
+
+void BM_Utf8ToGbk_Win32(benchmark::State& state) {
+    const Corpus& c = corpus();
+    for (auto _ : state) {
+        for (const auto& s : c.utf8) {
+            benchmark::DoNotOptimize(legacy::win32_utf8_to_gbk(s));
+        }
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * c.utf8_bytes));
+}
+#endif
+
+} // namespace
+
+BENCHMARK(BM_GbkToUtf8_Table);
+BENCHMARK(BM_Utf8ToGbk_Table);
+#ifdef _WIN32
+BENCHMARK(BM_GbkToUtf8_Win32);
+BENCHMARK(BM_Utf8ToGbk_Win32);
+#endif
@@ -0,0 +1,93 @@
+﻿#include "bench_inputs.h"
+#include "config.h"
+#include "course_parser.h"
+
+namespace {
+
+const char* const kCourses[] = {
+    u8"高等数学A（上）", u8"大学英语Ⅱ", u8"线性代数", u8"数学分析", u8"体育",
+    u8"中国近现代史纲要", u8"程序设计基础（C++）", u8"大学物理实验", u8"职业生涯规划及就业指导",
+    u8"离散数学", u8"马克思主义基本原理", u8"数据结构与算法",
+};
+
+} // namespace
+
+const std::string& input_at_command() {
+    static const std::string s = std::string("[CQ:at,qq=") + BOT_QQ + u8"] 　查询课表 ";
+    return s;
+}
+
+const std::string& input_image_message() {
+    static const std::string s =
+        u8"[CQ:image,summary=&#91;动画表情&#93;,file=4F7A1C9E2B3D5A6F8E0C1B2A3D4E5F60.gif,sub_type=1,"
+        u8"url=https://multimedia.nt.qq.com.cn/download?appid=1407&amp;fileid=EhRkN2Y0ZTg1YTk2MjQ0YzA5&amp;rkey=CAQSKAB6,"
+        u8"file_size=48213]哈哈哈哈";
+    return s;
+}
+
+const std::string& input_entity_message() {
+    static const std::string s = [] {
+        std::string t;
+        for (int i = 0; i < 8; ++i) {
+            t += u8"&#91;回复&#93; 老师说 &quot;周三下午的课调到周五&quot; &amp;&amp; 作业 &#123;第" +
+                std::to_string(i + 1) + u8"章&#125; 周日前交　";
+        }
+        return t;
+    }();
+    return s;
+}
+
+const std::string& input_pasted_timetable() {
+    static const std::string s = [] {
+        std::string t = u8"  \r\n";
+        int n = 0;
+        for (int weekday = 1; weekday <= 5; ++weekday) {
+            for (int slot = 0; slot < 5; ++slot, ++n) {
+                const int start = slot * 2 + 1;
+                const std::string course = kCourses[n % (sizeof(kCourses) / sizeof(kCourses[0]))];
+                if (n % 7 == 3) {
+                    // 部分同学用英文逗号
+                    t += course + "," + std::to_string(weekday) + ",1,16," + std::to_string(start) + "," +
+                        std::to_string(start + 1);
+                }
+                else {
+                    t += course + u8"，" + std::to_string(weekday) + u8"，" + std::to_string(1 + n % 3) + u8"，" +
+                        std::to_string(16 + n % 2) + u8"，" + std::to_string(start) + u8"，" + std::to_string(start + 1);
+                }
+                // 一行写两条时用中文分号隔开，其余换行
+                t += (n % 4 == 1) ? u8"；" : (n % 2 ? "\n" : "\r\n");
+            }
+        }
+        t += u8"  体育，8，1，16，3，4\r\n";  // 星期越界
+        t += u8"形势与政策，3，9，8\n";        // 字段不足
+        return t;
+    }();
+    return s;
+}
+
+const std::vector<std::string>& input_timetable_records() {
+    static const std::vector<std::string> v = split_records(input_pasted_timetable());
+    return v;
+}
+
+const std::string& input_schedule_file() {
+    static const std::string s = [] {
+        std::string t = "{\n  \"data\": {\n";
+        for (int user = 0; user < 40; ++user) {
+            t += "    \"" + std::to_string(3583457000LL + user * 7919) + "\": [\n";
+            for (int i = 0; i < 12; ++i) {
+                const std::string course = kCourses[(user + i) % (sizeof(kCourses) / sizeof(kCourses[0]))];
+                t += "      {\n        \"end_class\": " + std::to_string(i % 5 * 2 + 2) +
+                    ",\n        \"end_week\": 17,\n        \"name\": \"" + course +
+                    "\",\n        \"qq_number\": \"" + std::to_string(3583457000LL + user * 7919) +
+                    "\",\n        \"start_class\": " + std::to_string(i % 5 * 2 + 1) +
+                    ",\n        \"start_week\": 1,\n        \"weekday\": " + std::to_string(i % 5 + 1) + "\n      }";
+                t += (i + 1 < 12) ? ",\n" : "\n";
+            }
+            t += (user + 1 < 40) ? "    ],\n" : "    ]\n";
+        }
+        t += "  }\n}\n";
+        return t;
+    }();
+    return s;
+}
@@ -0,0 +1,24 @@
+﻿#pragma once
+#include <string>
+#include <vector>
+
+// 文本与解析热点的固定输入（不依赖录制帧，便于跨版本对比）：
+// 群里常见的中文指令、带 CQ 码的原始消息、粘贴的多行课表与持久化课表文件
+
+// 一条 @机器人 的短指令（raw_message，含全角空格）
+const std::string& input_at_command();
+
+// 图片 + 文本的原始消息：file 为长哈希名，url 带转义实体（NapCat 字符串格式上报）
+const std::string& input_image_message();
+
+// 转发 / 引用场景下实体较多的消息（&#91; &#93; &amp; &quot; 等）
+const std::string& input_entity_message();
+
+// 粘贴的多行课表（中文逗号为主，夹带英文逗号、中文分号、\r\n 与首尾空白，含少量格式错误行）
+const std::string& input_pasted_timetable();
+
+// 按上面课表拆出的单条记录
+const std::vector<std::string>& input_timetable_records();
+
+// 持久化课表文件内容（ScheduleLoader 读取时先做 UTF-8 校验）
+const std::string& input_schedule_file();
@@ -0,0 +1,25 @@
+﻿// 默认把结果另存为 JSON（bench_results.json），便于跨版本对比；命令行给出 --benchmark_out 时以命令行为准
+#include <benchmark/benchmark.h>
+#include <cstring>
+#include <vector>
+
+int main(int argc, char** argv) {
+    std::vector<char*> args(argv, argv + argc);
+    bool has_out = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--benchmark_out=", 16) == 0) has_out = true;
+    }
+    static char out_arg[] = "--benchmark_out=bench_results.json";
+    static char format_arg[] = "--benchmark_out_format=json";
+    if (!has_out) {
+        args.push_back(out_arg);
+        args.push_back(format_arg);
+    }
+    int count = static_cast<int>(args.size());
+    args.push_back(nullptr);
+    benchmark::Initialize(&count, args.data());
+    if (benchmark::ReportUnrecognizedArguments(count, args.data())) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
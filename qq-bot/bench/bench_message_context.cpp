@@ -0,0 +1,99 @@
+﻿// 群消息处理的逐条开销：旧版（每条消息重建规则表、每个匹配器重复取字段与判断 @）
+// vs 新版（MessageContext 只构建一次 + 启动时构建的指令表）
+// 输入为录制帧样本中的群消息，解码不计入；两侧回复生成器均为固定文本，只比较处理链本身
+#include "bench_frames.h"
+#include "command_registry.h"
+#include "group_message_event.h"
+#include "legacy_msg_handler.h"
+#include "message_context.h"
+#include "utf8.h"
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Corpus {
+    std::vector<nlohmann::json> dom;
+    std::vector<GroupMessageEvent> events;
+};
+
+const Corpus& corpus() {
+    static const Corpus c = [] {
+        Corpus c;
+        for (const auto& f : bench_frames()) {
+            if (!utf8_is_valid(f)) continue;
+            GroupMessageEvent ev;
+            if (f.find("\"message_type\":\"group\"") == std::string::npos) continue;
+            if (!decode_group_message_event(f, ev) || !ev.has_group_id || !ev.has_user_id || !ev.has_raw_message) continue;
+            c.events.push_back(std::move(ev));
+            c.dom.push_back(nlohmann::json::parse(f));
+        }
+        return c;
+    }();
+    return c;
+}
+
+std::string fixed_reply(const MessageContext&) { return "ok"; }
+
+// 与 src 中注册的指令集合一致（回复换成固定文本）
+const CommandRegistry& registry() {
+    static const CommandRegistry r = [] {
+        CommandRegistry r;
+        for (const char* text : { "", u8"帮助", u8"功能", u8"指令", "1", "hello", u8"你好" }) {
+            r.add_exact(text, Command{ fixed_reply });
+        }
+        r.add_exact("350234", Command{ fixed_reply, false });
+        for (const char* text : { u8"导入课表", u8"查询课表", u8"清空课表", u8"今日课程", u8"猜数", u8"有谁在上课" }) {
+            r.add_exact(text, Command{ fixed_reply });
+        }
+        Command quit{ fixed_reply };
+        quit.guard = [](const MessageContext& ctx) { return legacy::guess_games().count(ctx.group_id_str) > 0; };
+        r.add_exact(u8"退出", quit);
+        for (const char* text : { u8"设置提醒群", u8"绑定群聊", u8"取消绑定群聊", u8"解绑群聊", u8"绑定群提醒",
+                 u8"取消绑定群提醒", u8"解绑群提醒" }) {
+            r.add_exact(text, Command{ fixed_reply, false });
+        }
+        r.add_prefix(u8"设置学期", Command{ fixed_reply, false });
+        r.add_predicate([](const MessageContext& ctx) { return legacy::looks_like_course_import(ctx.text); },
+            Command{ fixed_reply });
+        r.add_predicate([](const MessageContext& ctx) {
+            if (legacy::guess_games().find(ctx.group_id_str) == legacy::guess_games().end()) return false;
+            try { std::stoi(ctx.text); return true; } catch (...) { return false; }
+        }, Command{ fixed_reply, false });
+        return r;
+    }();
+    return r;
+}
+
+void BM_HandleMessage_Legacy(benchmark::State& state) {
+    const Corpus& c = corpus();
+    nlohmann::json reply;
+    std::string name;
+    for (auto _ : state) {
+        for (const auto& m : c.dom) {
+            benchmark::DoNotOptimize(legacy::handle_group_message(m, reply, name));
+            benchmark::DoNotOptimize(name.data());
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * c.dom.size()));
+}
+
+void BM_HandleMessage_Context(benchmark::State& state) {
+    const Corpus& c = corpus();
+    const CommandRegistry& r = registry();
+    ReplyFrame reply;
+    for (auto _ : state) {
+        for (const auto& ev : c.events) {
+            const MessageContext ctx = make_message_context(ev);
+            benchmark::DoNotOptimize(r.dispatch(ctx, reply));
+            benchmark::DoNotOptimize(ctx.sender_name.data());
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * c.events.size()));
+}
+
+} // namespace
+
+BENCHMARK(BM_HandleMessage_Legacy);
+BENCHMARK(BM_HandleMessage_Context);
@@ -0,0 +1,70 @@
+﻿// +1 检测的逐条开销：8 个群交替的消息流，包含普通聊天、连续复读（每 3 条触发一次回复）与表情包图片
+// 上下文在计时外构建一次，只计 PlusOneKill::HandleMessage 本身（计数表为线程本地，跨迭代保留）
+#include "bench_inputs.h"
+#include "group_message_event.h"
+#include "message_context.h"
+#include "plusone_kill.h"
+#include "reply_frame.h"
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Stream {
+    std::vector<std::unique_ptr<GroupMessageEvent>> events; // 上下文中的视图指向事件，地址须稳定
+    std::vector<MessageContext> contexts;
+};
+
+const Stream& message_stream() {
+    static const Stream s = [] {
+        const char* const chats[] = {
+            u8"有人知道明天体育课在哪上吗", u8"收到", u8"[CQ:face,id=178]笑死", u8"周三的实验报告模板发一下",
+            u8"6", u8"今晚食堂几点关门", u8"老师说作业延期到下周一了", u8"[CQ:reply,id=1024]好的谢谢",
+        };
+        Stream s;
+        long long message_id = 1;
+        for (int round = 0; round < 64; ++round) {
+            for (int group = 0; group < 8; ++group) {
+                auto ev = std::make_unique<GroupMessageEvent>();
+                ev->group_id = 123456000 + group;
+                ev->user_id = 10000 + (round * 7 + group) % 50;
+                ev->message_id = message_id++;
+                ev->card = u8"同学" + std::to_string(ev->user_id % 50);
+                if (round % 8 < 3 && group % 2 == 0) {
+                    ev->raw_message = u8"+1";                  // 连续复读
+                }
+                else if (round % 8 < 3) {
+                    ev->raw_message = input_image_message();  // 连续发同一表情包
+                }
+                else {
+                    ev->raw_message = chats[(round + group) % 8];
+                }
+                ev->has_group_id = ev->has_user_id = ev->has_raw_message = true;
+                s.contexts.push_back(make_message_context(*ev));
+                s.events.push_back(std::move(ev));
+            }
+        }
+        return s;
+    }();
+    return s;
+}
+
+void BM_PlusOne_HandleMessage(benchmark::State& state) {
+    const Stream& s = message_stream();
+    ReplyFrame reply;
+    int64_t replies = 0;
+    for (auto _ : state) {
+        for (const auto& ctx : s.contexts) {
+            replies += PlusOneKill::HandleMessage(ctx, reply) ? 1 : 0;
+        }
+    }
+    benchmark::DoNotOptimize(replies);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * s.contexts.size()));
+    state.counters["replies_per_iter"] = benchmark::Counter(static_cast<double>(replies) / state.iterations());
+}
+
+} // namespace
+
+BENCHMARK(BM_PlusOne_HandleMessage);
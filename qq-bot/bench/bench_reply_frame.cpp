@@ -0,0 +1,64 @@
+﻿// 回复帧构建：旧版嵌套 json 对象 + dump() vs ReplyFrame 直接写入帧字节
+// 输入为一条带 @ 的短回复和一份多行课表回复；两种写法的结果先解析比对，不一致时报错
+#include "reply_frame.h"
+#include "utils.h"
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+#include <string>
+
+namespace {
+
+const std::string kGroupId = "123456789";
+
+const std::string& short_reply() {
+    static const std::string s = with_at("10001", u8"你好你好~");
+    return s;
+}
+
+const std::string& schedule_reply() {
+    static const std::string s = [] {
+        std::string t = u8"你的课表（按星期、节次升序，共20门）：\n";
+        for (int i = 1; i <= 20; ++i) {
+            t += std::to_string(i) + u8". 高等数学 \"A\" 周" + std::to_string(i % 7 + 1) + u8" 第1-2节 1-16周\n";
+        }
+        return with_at("10001", t);
+    }();
+    return s;
+}
+
+std::string legacy_frame(const std::string& group_id, const std::string& message) {
+    nlohmann::json reply = {
+        {"action", "send_group_msg"},
+        {"params", {
+            {"group_id", group_id},
+            {"message", message}
+        }}
+    };
+    return reply.dump();
+}
+
+void BM_ReplyFrame_Json(benchmark::State& state, const std::string& (*input)()) {
+    const std::string& msg = input();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(legacy_frame(kGroupId, msg));
+    }
+}
+
+void BM_ReplyFrame_Builder(benchmark::State& state, const std::string& (*input)()) {
+    const std::string& msg = input();
+    if (nlohmann::json::parse(ReplyFrame(kGroupId, msg).bytes()) != nlohmann::json::parse(legacy_frame(kGroupId, msg))) {
+        state.SkipWithError("ReplyFrame differs from json dump");
+        return;
+    }
+    for (auto _ : state) {
+        ReplyFrame frame(kGroupId, msg);
+        benchmark::DoNotOptimize(frame.bytes().data());
+    }
+}
+
+} // namespace
+
+BENCHMARK_CAPTURE(BM_ReplyFrame_Json, short, short_reply);
+BENCHMARK_CAPTURE(BM_ReplyFrame_Builder, short, short_reply);
+BENCHMARK_CAPTURE(BM_ReplyFrame_Json, schedule, schedule_reply);
+BENCHMARK_CAPTURE(BM_ReplyFrame_Builder, schedule, schedule_reply);
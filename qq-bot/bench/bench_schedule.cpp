@@ -0,0 +1,59 @@
+﻿// 导入课表的解析：粘贴的多行课表先判定是否为导入消息，再拆分记录、逐条解析
+// BM_ImportTimetable 串起整条导入路径（与 schedule_set 中“导入课表文本”规则一致，不写入全局课表）
+#include "bench_inputs.h"
+#include "course_parser.h"
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+void BM_IsCourseImportMessage(benchmark::State& state) {
+    const std::string& s = input_pasted_timetable();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(is_course_import_message(s));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * s.size()));
+}
+
+void BM_SplitRecords(benchmark::State& state) {
+    const std::string& s = input_pasted_timetable();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(split_records(s));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * s.size()));
+}
+
+void BM_ParseCourseStr(benchmark::State& state) {
+    const auto& records = input_timetable_records();
+    Schedule out;
+    for (auto _ : state) {
+        for (const auto& rec : records) {
+            benchmark::DoNotOptimize(parse_course_str(rec, out, "3583457727"));
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * records.size()));
+}
+
+void BM_ImportTimetable(benchmark::State& state) {
+    const std::string& s = input_pasted_timetable();
+    std::vector<Schedule> imported;
+    for (auto _ : state) {
+        imported.clear();
+        if (is_course_import_message(s)) {
+            Schedule sched;
+            for (const auto& rec : split_records(s)) {
+                if (parse_course_str(rec, sched, "3583457727")) imported.push_back(sched);
+            }
+        }
+        benchmark::DoNotOptimize(imported.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * s.size()));
+}
+
+} // namespace
+
+BENCHMARK(BM_IsCourseImportMessage);
+BENCHMARK(BM_SplitRecords);
+BENCHMARK(BM_ParseCourseStr);
+BENCHMARK(BM_ImportTimetable);
@@ -0,0 +1,132 @@
+﻿// 文本小工具的单次开销：trim_space、含实体消息的规范化、@机器人 判断、CQ 图片 file 提取、UTF-8 校验
+// 输入见 bench_inputs.h（固定的中文 / CQ 码样例），旧版实现来自 legacy/ 作为对照
+#include "bench_inputs.h"
+#include "cq_code.h"
+#include "group_message_event.h"
+#include "legacy_cq.h"
+#include "legacy_msg_handler.h"
+#include "legacy_utf8.h"
+#include "text_normalize.h"
+#include "utf8.h"
+#include "utils.h"
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 课表中的一行（两端带空白，trim 后仍需拷贝整行）
+const std::string& padded_record() {
+    static const std::string s = u8" \t高等数学A（上），1，1，16，1，2\r\n";
+    return s;
+}
+
+void BM_TrimSpace(benchmark::State& state, const std::string& (*input)()) {
+    const std::string& s = input();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(trim_space(s));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * s.size()));
+}
+
+// 实体密集的消息：现行实体解码并在 normalize_text_into 的单趟扫描里，没有单独的解码入口，
+// 因此两侧都计完整的规范化（去控制 / 不可见字符、trim、解码），旧版为 normalize_text 的逐项 find/erase + 逐实体 replace
+void BM_NormalizeEntities_Legacy(benchmark::State& state) {
+    const std::string& s = input_entity_message();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(legacy::normalize_text(s));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * s.size()));
+}
+
+void BM_NormalizeEntities_SinglePass(benchmark::State& state) {
+    const std::string& s = input_entity_message();
+    std::string out;
+    for (auto _ : state) {
+        normalize_text_into(s, out);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * s.size()));
+}
+
+// @机器人 判断：旧版每次从 DOM 拷贝 raw_message 并 trim；现行直接扫描已解码事件
+void BM_IsAtBot_Legacy(benchmark::State& state) {
+    const nlohmann::json msg = { { "raw_message", input_at_command() } };
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(legacy::is_at_bot(msg));
+    }
+}
+
+void BM_IsAtBot_Event(benchmark::State& state) {
+    GroupMessageEvent ev;
+    ev.raw_message = input_at_command();
+    ev.has_raw_message = true;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(is_at_bot(ev));
+    }
+}
+
+// CQ 图片 file 提取：旧版 find + substr 拷贝；现行切分为段视图后取首段主参数
+void BM_ExtractImageFile_Legacy(benchmark::State& state) {
+    const std::string& s = input_image_message();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(legacy::extract_cq_image_file(s));
+    }
+}
+
+void BM_ExtractImageFile_Tokenize(benchmark::State& state) {
+    const std::string& s = input_image_message();
+    std::vector<CqSegment> segments;
+    for (auto _ : state) {
+        cq_tokenize(s, segments);
+        std::string_view file;
+        if (!segments.empty() && segments.front().type == CqType::Image) file = segments.front().value;
+        benchmark::DoNotOptimize(file.data());
+    }
+}
+
+// UTF-8 校验：旧版帧入口（main.cpp）与课表读取（schedule_loader.cpp）的两个逐字节循环，
+// 现行两处都调用 utf8_is_valid；输入为短指令、粘贴课表与课表文件（bench_utf8.cpp 另在录制帧上对比）
+template <bool (*Validate)(const std::string&)>
+void BM_Utf8Valid(benchmark::State& state, const std::string& (*input)()) {
+    const std::string& s = input();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Validate(s));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * s.size()));
+}
+
+bool utf8_is_valid_string(const std::string& s) { return utf8_is_valid(s); }
+
+void BM_Utf8Valid_LegacyMain(benchmark::State& state, const std::string& (*input)()) {
+    BM_Utf8Valid<legacy::main_is_valid_utf8>(state, input);
+}
+
+void BM_Utf8Valid_LegacyLoader(benchmark::State& state, const std::string& (*input)()) {
+    BM_Utf8Valid<legacy::loader_utf8_validate>(state, input);
+}
+
+void BM_Utf8Valid_Simd(benchmark::State& state, const std::string& (*input)()) {
+    BM_Utf8Valid<utf8_is_valid_string>(state, input);
+}
+
+} // namespace
+
+BENCHMARK_CAPTURE(BM_TrimSpace, record, padded_record);
+BENCHMARK_CAPTURE(BM_TrimSpace, timetable, input_pasted_timetable);
+BENCHMARK(BM_NormalizeEntities_Legacy);
+BENCHMARK(BM_NormalizeEntities_SinglePass);
+BENCHMARK(BM_IsAtBot_Legacy);
+BENCHMARK(BM_IsAtBot_Event);
+BENCHMARK(BM_ExtractImageFile_Legacy);
+BENCHMARK(BM_ExtractImageFile_Tokenize);
+BENCHMARK_CAPTURE(BM_Utf8Valid_LegacyMain, command, input_at_command);
+BENCHMARK_CAPTURE(BM_Utf8Valid_LegacyLoader, command, input_at_command);
+BENCHMARK_CAPTURE(BM_Utf8Valid_Simd, command, input_at_command);
+BENCHMARK_CAPTURE(BM_Utf8Valid_LegacyMain, timetable, input_pasted_timetable);
+BENCHMARK_CAPTURE(BM_Utf8Valid_LegacyLoader, timetable, input_pasted_timetable);
+BENCHMARK_CAPTURE(BM_Utf8Valid_Simd, timetable, input_pasted_timetable);
+BENCHMARK_CAPTURE(BM_Utf8Valid_LegacyMain, schedule_file, input_schedule_file);
+BENCHMARK_CAPTURE(BM_Utf8Valid_LegacyLoader, schedule_file, input_schedule_file);
+BENCHMARK_CAPTURE(BM_Utf8Valid_Simd, schedule_file, input_schedule_file);
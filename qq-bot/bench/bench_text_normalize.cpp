@@ -0,0 +1,50 @@
+﻿// 指令文本规范化：旧版逐项 find/erase + 逐实体 replace vs 单趟状态机写入复用缓冲
+// 输入一条普通指令和一份粘贴的长课表（夹带全角空格、NBSP、零宽空格与转义实体，旧版在此为平方级）
+// 新旧结果的一致性由 tools/normalize_check 的差分检查保证，这里只计时
+#include "legacy_msg_handler.h"
+#include "text_normalize.h"
+#include <benchmark/benchmark.h>
+#include <string>
+
+namespace {
+
+const std::string& short_command() {
+    static const std::string s = u8" ​课表 周三　";
+    return s;
+}
+
+const std::string& pasted_timetable() {
+    static const std::string s = [] {
+        std::string t;
+        for (int i = 0; i < 200; ++i) {
+            t += u8"第" + std::to_string(i % 12 + 1) + u8"节　高等数学 &#91;教A-101&#93;　周1-16\r\n";
+        }
+        return t;
+    }();
+    return s;
+}
+
+void BM_Normalize_Legacy(benchmark::State& state, const std::string& (*input)()) {
+    const std::string& s = input();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(legacy::normalize_text(s));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * s.size()));
+}
+
+void BM_Normalize_SinglePass(benchmark::State& state, const std::string& (*input)()) {
+    const std::string& s = input();
+    std::string out;
+    for (auto _ : state) {
+        normalize_text_into(s, out);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * s.size()));
+}
+
+} // namespace
+
+BENCHMARK_CAPTURE(BM_Normalize_Legacy, command, short_command);
+BENCHMARK_CAPTURE(BM_Normalize_SinglePass, command, short_command);
+BENCHMARK_CAPTURE(BM_Normalize_Legacy, timetable, pasted_timetable);
+BENCHMARK_CAPTURE(BM_Normalize_SinglePass, timetable, pasted_timetable);
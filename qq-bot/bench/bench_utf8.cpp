@@ -0,0 +1,65 @@
+﻿// UTF-8 校验：旧版两个逐字节循环 vs utils/utf8 向量化实现，输入为录制的帧样本
+#include "bench_frames.h"
+#include "legacy_utf8.h"
+#include "utf8.h"
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+
+namespace {
+
+template <bool (*Validate)(const std::string&)>
+void run_over_frames(benchmark::State& state) {
+    const auto& frames = bench_frames();
+    for (auto _ : state) {
+        for (const auto& f : frames) {
+            benchmark::DoNotOptimize(Validate(f));
+        }
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bench_frames_bytes()));
+}
+
+bool simd_validate(const std::string& s) { return utf8_is_valid(s); }
+
+void BM_Utf8_LegacyMain(benchmark::State& state) { run_over_frames<legacy::main_is_valid_utf8>(state); }
+void BM_Utf8_LegacyLoader(benchmark::State& state) { run_over_frames<legacy::loader_utf8_validate>(state); }
+void BM_Utf8_Simd(benchmark::State& state) { run_over_frames<simd_validate>(state); }
+
+// 编码判定：旧路径靠 json::parse 抛 316/101 才知道是 GBK，新路径先校验
+const std::string& first_invalid_frame() {
+    static const std::string frame = [] {
+        for (const auto& f : bench_frames()) {
+            if (!utf8_is_valid(f)) return f;
+        }
+        return std::string("{\"raw_message\":\"\xC4\xE3\xBA\xC3\"}");
+    }();
+    return frame;
+}
+
+void BM_DetectGbk_ParseException(benchmark::State& state) {
+    const std::string& frame = first_invalid_frame();
+    for (auto _ : state) {
+        bool gbk = false;
+        try {
+            auto j = nlohmann::json::parse(frame, nullptr, true, true);
+            benchmark::DoNotOptimize(j);
+        } catch (const nlohmann::json::exception& e) {
+            gbk = (e.id == 316 || e.id == 101);
+        }
+        benchmark::DoNotOptimize(gbk);
+    }
+}
+
+void BM_DetectGbk_Validate(benchmark::State& state) {
+    const std::string& frame = first_invalid_frame();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(!utf8_is_valid(frame));
+    }
+}
+
+} // namespace
+
+BENCHMARK(BM_Utf8_LegacyMain);
+BENCHMARK(BM_Utf8_LegacyLoader);
+BENCHMARK(BM_Utf8_Simd);
+BENCHMARK(BM_DetectGbk_ParseException);
+BENCHMARK(BM_DetectGbk_Validate);
@@ -0,0 +1,39 @@
+﻿#pragma once
+// 旧版各处零散的 CQ 码处理（msg_handler 的 @ 标记查找、plusone_kill 的图片判断与 file 提取），原样保留作为基准对照（勿在 src 中使用）
+#include "config.h"
+#include <string>
+
+namespace legacy {
+
+// msg_handler：找到 @机器人 标记后截取其后的正文（拷贝）
+inline std::string strip_at_bot(const std::string& raw) {
+    std::string raw_msg = raw;
+    std::string at_tag = "[CQ:at,qq=" + std::string(BOT_QQ) + "]";
+    size_t at_pos = raw_msg.find(at_tag);
+    if (at_pos != std::string::npos) {
+        raw_msg = raw_msg.substr(at_pos + at_tag.length());
+    }
+    return raw_msg;
+}
+
+// plusone_kill：从 CQ:image 文本中提取 file=XXX 的值
+inline std::string extract_cq_image_file(const std::string& content) {
+    const std::string key = "file=";
+    auto pos = content.find(key);
+    if (pos == std::string::npos) return {};
+    pos += key.size();
+    size_t end = content.find_first_of(",]", pos);
+    if (end == std::string::npos) end = content.size();
+    return content.substr(pos, end - pos);
+}
+
+// plusone_kill：图片消息按 file 计数，其余按整条文本计数
+inline std::string plusone_key(const std::string& content) {
+    if (content.compare(0, 9, "[CQ:image") == 0) {
+        std::string file_key = extract_cq_image_file(content);
+        return file_key.empty() ? std::string() : "img:" + file_key;
+    }
+    return content.empty() ? std::string() : "txt:" + content;
+}
+
+} // namespace legacy
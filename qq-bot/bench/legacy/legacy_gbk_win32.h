@@ -0,0 +1,38 @@
+﻿#pragma once
+// 旧版经 UTF-16 中转的 Win32 编码转换，原样保留作为基准对照（仅 Windows）
+#ifdef _WIN32
+#include <windows.h>
+#include <string>
+
+namespace legacy {
+
+inline std::string win32_gbk_to_utf8(const std::string& gbk_str) {
+    int wide_len = MultiByteToWideChar(936, 0, gbk_str.c_str(), -1, nullptr, 0);
+    if (wide_len == 0) return gbk_str;
+    std::wstring wide_str(wide_len, 0);
+    MultiByteToWideChar(936, 0, gbk_str.c_str(), -1, &wide_str[0], wide_len);
+
+    int utf8_len = WideCharToMultiByte(CP_UTF8, 0, wide_str.c_str(), -1, nullptr, 0, nullptr, nullptr);
+    if (utf8_len == 0) return gbk_str;
+    std::string utf8_str(utf8_len, 0);
+    WideCharToMultiByte(CP_UTF8, 0, wide_str.c_str(), -1, &utf8_str[0], utf8_len, nullptr, nullptr);
+    utf8_str.pop_back();
+    return utf8_str;
+}
+
+inline std::string win32_utf8_to_gbk(const std::string& utf8_str) {
+    int wide_len = MultiByteToWideChar(CP_UTF8, 0, utf8_str.c_str(), -1, nullptr, 0);
+    if (wide_len == 0) return utf8_str;
+    std::wstring wide_str(wide_len, 0);
+    MultiByteToWideChar(CP_UTF8, 0, utf8_str.c_str(), -1, &wide_str[0], wide_len);
+
+    int gbk_len = WideCharToMultiByte(936, 0, wide_str.c_str(), -1, nullptr, 0, nullptr, nullptr);
+    if (gbk_len == 0) return utf8_str;
+    std::string gbk_str(gbk_len, 0);
+    WideCharToMultiByte(936, 0, wide_str.c_str(), -1, &gbk_str[0], gbk_len, nullptr, nullptr);
+    gbk_str.pop_back();
+    return gbk_str;
+}
+
+} // namespace legacy
+#endif // _WIN32
@@ -0,0 +1,198 @@
+﻿#pragma once
+// 旧版群消息处理的逐条开销（指令表与 MessageContext 之前），原样保留作为基准对照（勿在 src 中使用）
+// 规则的匹配条件与旧版一致，回复生成器换成固定文本，不触碰课表 / 游戏等业务状态
+#include "config.h"
+#include "utils.h"
+#include <nlohmann/json.hpp>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace legacy {
+
+using nlohmann::json;
+
+// 旧版 ReplyRule：单参数生成器被再包一层 std::function
+struct ReplyRule {
+    std::function<bool(const json&, const std::string&)> matcher;
+    std::function<std::string(const std::string&, const std::string&)> reply_generator;
+
+    ReplyRule(std::function<bool(const json&, const std::string&)> m, std::function<std::string(const std::string&)> r)
+        : matcher(std::move(m))
+        , reply_generator([r](const std::string& group_id, const std::string&) { return r(group_id); }) {}
+};
+
+// 旧版 utils.cpp is_at_bot：每次拷贝 raw_message、trim、拼接标签并扫描两遍
+inline bool is_at_bot(const json& msg_data) {
+    if (!msg_data.contains("raw_message") || !msg_data["raw_message"].is_string()) {
+        return false;
+    }
+    std::string raw_msg = msg_data["raw_message"].get<std::string>();
+    std::string trimmed_raw = trim_space(raw_msg);
+    std::string at_tag = "[CQ:at,qq=" + std::string(BOT_QQ) + "]";
+    return raw_msg.find(at_tag) != std::string::npos
+        || trimmed_raw.find(at_tag) != std::string::npos;
+}
+
+inline std::string decode_html_entities(const std::string& s) {
+    std::string out = s;
+    auto replace_all = [&](const char* from, const char* to) {
+        std::string f(from);
+        std::string t(to);
+        std::size_t pos = 0;
+        while ((pos = out.find(f, pos)) != std::string::npos) {
+            out.replace(pos, f.length(), t);
+            pos += t.length();
+        }
+    };
+    replace_all("&#91;", "[");
+    replace_all("&#93;", "]");
+    replace_all("&quot;", "\"");
+    replace_all("&amp;", "&");
+    replace_all("&#123;", "{");
+    replace_all("&#125;", "}");
+    return out;
+}
+
+inline std::string normalize_text(const std::string& s) {
+    std::string out;
+    out.reserve(s.size());
+    for (unsigned char c : s) {
+        if (c < 32 || c == 127) continue;
+        out.push_back(static_cast<char>(c));
+    }
+    auto erase_seq = [&](const char* seq, size_t len) {
+        for (;;) {
+            auto pos = out.find(std::string(seq, len));
+            if (pos == std::string::npos) break;
+            out.erase(pos, len);
+        }
+    };
+    erase_seq("\xEF\xBB\xBF", 3);
+    erase_seq("\xE2\x80\x8B", 3);
+    erase_seq("\xC2\xA0", 2);
+    erase_seq("\xE3\x80\x80", 3);
+    out = trim_space(out);
+    out = decode_html_entities(out);
+    return out;
+}
+
+// 猜数进行中的群（基准中始终为空，与新版共用同一判断方式）
+inline std::unordered_map<std::string, int>& guess_games() {
+    static std::unordered_map<std::string, int> games;
+    return games;
+}
+
+// 课表导入文本的粗判（基准中新旧两侧共用）
+inline bool looks_like_course_import(const std::string& content) {
+    return content.find(u8"，") != std::string::npos;
+}
+
+inline std::string fixed_reply(const std::string&) { return "ok"; }
+
+inline const std::vector<ReplyRule>& default_rules() {
+    static const std::vector<ReplyRule> rules = {
+        { [](const json& m, const std::string& c) {
+            const bool at_me = is_at_bot(m);
+            const bool is_help = c.empty() || c == u8"帮助" || c == u8"功能" || c == u8"指令";
+            return at_me && is_help; }, fixed_reply },
+        { [](const json& m, const std::string& c) { return is_at_bot(m) && c == "1"; }, fixed_reply },
+        { [](const json& m, const std::string& c) { return is_at_bot(m) && c == "hello"; }, fixed_reply },
+        { [](const json& m, const std::string& c) { return is_at_bot(m) && c == u8"你好"; }, fixed_reply },
+        { [](const json&, const std::string& c) { return c == "350234"; }, fixed_reply },
+    };
+    return rules;
+}
+
+// 以下三组在旧版中每条消息都重新构建
+inline std::vector<ReplyRule> schedule_rules() {
+    return {
+        { [](const json& m, const std::string& c) { return is_at_bot(m) && c == u8"导入课表"; }, fixed_reply },
+        { [](const json& m, const std::string& c) { return is_at_bot(m) && c == u8"查询课表"; }, fixed_reply },
+        { [](const json& m, const std::string& c) { return is_at_bot(m) && looks_like_course_import(c); }, fixed_reply },
+        { [](const json& m, const std::string& c) { return is_at_bot(m) && c == u8"清空课表"; }, fixed_reply },
+        { [](const json& m, const std::string& c) { return is_at_bot(m) && c == u8"今日课程"; }, fixed_reply },
+        { [](const json&, const std::string& c) {
+            const std::string prefix = u8"设置学期";
+            return !c.empty() && c.compare(0, prefix.size(), prefix) == 0; }, fixed_reply },
+    };
+}
+
+inline std::vector<ReplyRule> guess_number_rules() {
+    std::vector<ReplyRule> rules;
+    rules.push_back({ [](const json& m, const std::string& c) { return is_at_bot(m) && c == u8"猜数"; }, fixed_reply });
+    rules.push_back({ [](const json& m, const std::string& c) {
+        std::string group_id = std::to_string(m["group_id"].get<long long>());
+        if (guess_games().find(group_id) == guess_games().end()) return false;
+        try { std::stoi(c); return true; } catch (...) { return false; } }, fixed_reply });
+    rules.push_back({ [](const json& m, const std::string& c) {
+        std::string group_id = std::to_string(m["group_id"].get<long long>());
+        return is_at_bot(m) && c == u8"退出" && guess_games().count(group_id) > 0; }, fixed_reply });
+    return rules;
+}
+
+inline std::vector<ReplyRule> class_inquiry_rules() {
+    std::vector<ReplyRule> rules;
+    rules.push_back({ [](const json& m, const std::string& c) { return is_at_bot(m) && c == u8"有谁在上课"; }, fixed_reply });
+    return rules;
+}
+
+inline bool generate_with_rules(const json& msg_data, const std::string& content, const std::string& group_id,
+    const std::vector<ReplyRule>& rules, json& reply) {
+    for (const auto& rule : rules) {
+        if (!rule.matcher(msg_data, content)) continue;
+        std::string sender_qq;
+        if (msg_data.contains("sender") && msg_data["sender"].contains("user_id")) {
+            sender_qq = std::to_string(msg_data["sender"]["user_id"].get<long long>());
+        }
+        const std::string plain = rule.reply_generator(group_id, content);
+        const std::string message = sender_qq.empty() ? plain : with_at(sender_qq, plain);
+        reply = { {"action", "send_group_msg"}, {"params", {{"group_id", group_id}, {"message", message}}} };
+        return true;
+    }
+    return false;
+}
+
+// 旧版 handle_group_message 的取字段 / 规范化 / 规则匹配，以及随后 update_member_display_name 的重新解析
+// 返回是否产生回复；display_name 为成员缓存将写入的名称
+inline bool handle_group_message(const json& msg_data, json& reply, std::string& display_name) {
+    std::string group_id = std::to_string(msg_data["group_id"].get<long long>());
+    std::string sender_qq;
+    if (msg_data.contains("user_id") && msg_data["user_id"].is_number()) {
+        sender_qq = std::to_string(msg_data["user_id"].get<long long>());
+    }
+    std::string raw_msg = msg_data["raw_message"].get<std::string>();
+    std::string at_tag = "[CQ:at,qq=" + std::string(BOT_QQ) + "]";
+    size_t at_pos = raw_msg.find(at_tag);
+    if (at_pos != std::string::npos) {
+        raw_msg = raw_msg.substr(at_pos + at_tag.length());
+    }
+    std::string trimmed_msg = normalize_text(raw_msg);
+
+    bool need_reply = generate_with_rules(msg_data, trimmed_msg, group_id, default_rules(), reply);
+    if (!need_reply) need_reply = generate_with_rules(msg_data, trimmed_msg, group_id, schedule_rules(), reply);
+    if (!need_reply) need_reply = generate_with_rules(msg_data, trimmed_msg, group_id, guess_number_rules(), reply);
+    if (!need_reply) need_reply = generate_with_rules(msg_data, trimmed_msg, group_id, class_inquiry_rules(), reply);
+    if (!need_reply) {
+        need_reply = trimmed_msg == u8"设置提醒群" || trimmed_msg == u8"绑定群聊" || trimmed_msg == u8"取消绑定群聊"
+            || trimmed_msg == u8"解绑群聊" || trimmed_msg == u8"绑定群提醒" || trimmed_msg == u8"取消绑定群提醒"
+            || trimmed_msg == u8"解绑群提醒";
+    }
+
+    // update_member_display_name：再次取群号、QQ 与 sender 字段
+    std::string qq = std::to_string(msg_data["user_id"].get<long long>());
+    std::string gid = std::to_string(msg_data["group_id"].get<long long>());
+    display_name.clear();
+    if (msg_data.contains("sender") && msg_data["sender"].is_object()) {
+        const auto& s = msg_data["sender"];
+        if (s.contains("card") && s["card"].is_string()) display_name = trim_space(s["card"].get<std::string>());
+        if (display_name.empty() && s.contains("nickname") && s["nickname"].is_string()) {
+            display_name = trim_space(s["nickname"].get<std::string>());
+        }
+    }
+    if (display_name.empty()) display_name = qq;
+    return need_reply;
+}
+
+} // namespace legacy
@@ -0,0 +1,81 @@
+﻿#pragma once
+// 旧版逐字节 UTF-8 校验，原样保留作为基准对照（勿在 src 中使用）
+#include <string>
+
+namespace legacy {
+
+// 原 main.cpp is_valid_utf8：仅检查结构合法性
+inline bool main_is_valid_utf8(const std::string& s) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(s.data());
+    size_t i = 0, n = s.size();
+    while (i < n) {
+        unsigned char c = p[i];
+        size_t len = 0;
+        if (c <= 0x7F) {
+            i += 1;
+            continue;
+        }
+        else if ((c >> 5) == 0x6) {
+            len = 2;
+        }
+        else if ((c >> 4) == 0xE) {
+            len = 3;
+        }
+        else if ((c >> 3) == 0x1E) {
+            len = 4;
+        }
+        else {
+            return false;
+        }
+        if (i + len > n) return false;
+        for (size_t k = 1; k < len; ++k) {
+            if ((p[i + k] >> 6) != 0x2) return false;
+        }
+        i += len;
+    }
+    return true;
+}
+
+// 原 schedule_loader.cpp utf8_validate
+inline bool loader_utf8_validate(const std::string& s) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(s.data());
+    size_t i = 0;
+    const size_t len = s.size();
+    while (i < len) {
+        unsigned char c = bytes[i];
+        if ((c & 0x80) == 0) {
+            i += 1;
+        } else if ((c & 0xE0) == 0xC0) {
+            if (i + 1 >= len) return false;
+            unsigned char c1 = bytes[i + 1];
+            if ((c1 & 0xC0) != 0x80) return false;
+            unsigned int cp = ((c & 0x1F) << 6) | (c1 & 0x3F);
+            if (cp < 0x80) return false;
+            i += 2;
+        } else if ((c & 0xF0) == 0xE0) {
+            if (i + 2 >= len) return false;
+            unsigned char c1 = bytes[i + 1];
+            unsigned char c2 = bytes[i + 2];
+            if ((c1 & 0xC0) != 0x80 || (c2 & 0xC0) != 0x80) return false;
+            unsigned int cp = ((c & 0x0F) << 12) | ((c1 & 0x3F) << 6) | (c2 & 0x3F);
+            if (cp < 0x800) return false;
+            if (cp >= 0xD800 && cp <= 0xDFFF) return false;
+            i += 3;
+        } else if ((c & 0xF8) == 0xF0) {
+            if (i + 3 >= len) return false;
+            unsigned char c1 = bytes[i + 1];
+            unsigned char c2 = bytes[i + 2];
+            unsigned char c3 = bytes[i + 3];
+            if ((c1 & 0xC0) != 0x80 || (c2 & 0xC0) != 0x80 || (c3 & 0xC0) != 0x80) return false;
+            unsigned int cp = ((c & 0x07) << 18) | ((c1 & 0x3F) << 12) | ((c2 & 0x3F) << 6) | (c3 & 0x3F);
+            if (cp < 0x10000) return false;
+            if (cp > 0x10FFFF) return false;
+            i += 4;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace legacy
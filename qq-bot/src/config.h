@@ -12,4 +12,65 @@ const char* const BOT_QQ = "3373368470";  // 替换为你的机器人QQ
 const char* const LOG_FILE = "robot_log.txt";  // 日志文件路径
 
 const char* const SCHEDULE_DATA_FILE = "schedules.json";  // 课表数据文件
+
+// 消息处理分片数：读循环只负责解码与派发，业务处理按群号散列到各分片线程执行
+// 同一个群的消息总在同一分片上依次处理；0 表示按 CPU 核数
+const int MESSAGE_SHARDS = 0;
+
+// 入口队列（读循环 -> 分片线程，每个分片一条）：同一个群按到达顺序处理，群之间按 指令/API回执 > 游戏输入 > 普通闲聊 的优先级调度
+// 深度超过高水位后丢弃新的闲聊消息；达到容量上限时淘汰最旧的低优先级消息
+const int INGRESS_QUEUE_CAPACITY = 2048;
+const int INGRESS_HIGH_WATER = 512;
+
+// 断线重连：指数退避（毫秒），每次等待在 [delay/2, delay] 内随机抖动
+const int RECONNECT_BASE_DELAY_MS = 1000;
+const int RECONNECT_MAX_DELAY_MS = 60000;
+// 连接保持超过该时长（秒）后断开，退避从头开始计算
+const int RECONNECT_STABLE_SEC = 30;
+
+// 心跳看门狗：收到过心跳后，超过 心跳间隔×倍数 未再收到 OneBot meta_event 心跳即判定链路停滞
+// （从未收到心跳时不生效，由 WS_IDLE_TIMEOUT_SEC 的 ping/pong 判定）
+const int HEARTBEAT_DEFAULT_INTERVAL_MS = 30000; // 心跳帧未带 interval 时使用
+const int HEARTBEAT_MISS_FACTOR = 2;
+// WebSocket 空闲超时（秒）：空闲一半时间后自动发 ping，超时仍未收到任何数据（含 pong）即断开
+const int WS_IDLE_TIMEOUT_SEC = 10;
+
+// permessage-deflate：握手时向 NapCat 提供压缩扩展，服务端不支持时自动回退为不压缩
+const bool WS_DEFLATE_ENABLE = true;
+const int WS_DEFLATE_CLIENT_MAX_WINDOW_BITS = 15; // 出站压缩窗口 9-15，越小越省内存
+const int WS_DEFLATE_SERVER_MAX_WINDOW_BITS = 15; // 请求服务端使用的压缩窗口 9-15
+const int WS_DEFLATE_COMP_LEVEL = 6;              // 出站压缩级别 0-9
+const int WS_DEFLATE_MEM_LEVEL = 4;               // zlib memLevel 1-9
+
+// OneBot API 请求期限（毫秒）：超时未收到同 echo 的回执即判定失败，由定时器按间隔清扫
+const int RPC_DEFAULT_TIMEOUT_MS = 10000;
+const int RPC_MEMBER_LIST_TIMEOUT_MS = 30000; // 大群成员列表回执较慢
+const int RPC_SWEEP_INTERVAL_MS = 500;
+
+// 出站发送限速（令牌桶）：每群与全局各一个，两者都有令牌才发出；交互回复优先于批量推送
+const double OUTBOUND_GLOBAL_RATE_PER_SEC = 5.0;
+const double OUTBOUND_GLOBAL_BURST = 10.0;
+const double OUTBOUND_GROUP_RATE_PER_SEC = 1.0;
+const double OUTBOUND_GROUP_BURST = 3.0;
+// 批量推送（如每晚课程提醒）在该窗口（毫秒）内均匀摊开；仍受上面的令牌桶约束
+const int OUTBOUND_BULK_SPREAD_MS = 120000;
+
+// 运行统计（发送队列深度、写延迟等）输出间隔（秒）
+const int STATS_LOG_INTERVAL_SEC = 60;
+
+// 可在群内 @机器人 发送“状态”查看处理链各阶段耗时的 QQ 号，逗号分隔；为空时该指令不响应
+const char* const ADMIN_QQS = "";
+
+// 原始帧抓包文件（二进制，供 tools/replay 回放）；为空表示不抓包，也可用命令行参数 --capture <文件> 开启
+const char* const CAPTURE_FILE = "";
+
+// 异步日志：调用方只把文本拷入环形缓冲的定长记录，后台线程批量格式化并写出
+const int LOG_MIN_LEVEL = 1;                    // 0 Debug / 1 Info / 2 Warn / 3 Error，低于该级别的不记录
+const int LOG_RING_CAPACITY = 4096;             // 环形缓冲记录数（2 的幂），写满后新记录丢弃并计数
+const int LOG_RECORD_TEXT_BYTES = 480;          // 每个槽位的文本字节数，较长的一行占用多个连续槽位
+const int LOG_MAX_RECORD_SLOTS = 16;            // 一行最多占用的槽位数，超出部分截断并注明原长度
+const int LOG_FLUSH_INTERVAL_MS = 50;           // 后台线程空闲时的轮询间隔
+const int LOG_SAMPLE_RECEIVED_EVERY = 1;        // "Received message" 每 N 条记录 1 条（1 为全部记录）
+const long long LOG_MAX_FILE_BYTES = 16LL * 1024 * 1024; // 日志文件超过该大小后轮转
+const int LOG_MAX_FILES = 5;                    // 轮转保留的历史文件数（robot_log.txt.1 ~ .N）
 #endif // CONFIG_H
@@ -0,0 +1,114 @@
+﻿#include "command_registry.h"
+#include "pipeline_stats.h"
+#include "utils.h"
+#include <algorithm>
+
+using steady_clock = std::chrono::steady_clock;
+
+void CommandRegistry::attach_stat(Command& cmd, const std::string& name)
+{
+    rule_stats_.push_back(std::make_unique<RuleStat>());
+    rule_stats_.back()->name = name;
+    cmd.latency = &rule_stats_.back()->latency;
+}
+
+void CommandRegistry::add_exact(const std::string& text, Command cmd)
+{
+    attach_stat(cmd, text);
+    exact_[text].push_back(std::move(cmd));
+}
+
+void CommandRegistry::add_prefix(const std::string& prefix, Command cmd)
+{
+    attach_stat(cmd, prefix + "...");
+    prefix_[prefix].push_back(std::move(cmd));
+    if (std::find(prefix_lengths_.begin(), prefix_lengths_.end(), prefix.size()) == prefix_lengths_.end()) {
+        prefix_lengths_.push_back(prefix.size());
+        std::sort(prefix_lengths_.begin(), prefix_lengths_.end(), std::greater<std::size_t>());
+    }
+}
+
+void CommandRegistry::add_predicate(CommandPredicate matcher, Command cmd, const std::string& name)
+{
+    attach_stat(cmd, name.empty() ? "predicate#" + std::to_string(predicates_.size() + 1) : name);
+    cmd.guard = std::move(matcher);
+    predicates_.push_back(std::move(cmd));
+}
+
+std::size_t CommandRegistry::size() const
+{
+    std::size_t n = predicates_.size();
+    for (const auto& kv : exact_) n += kv.second.size();
+    for (const auto& kv : prefix_) n += kv.second.size();
+    return n;
+}
+
+std::vector<const CommandRegistry::RuleStat*> CommandRegistry::rule_stats() const
+{
+    std::vector<const RuleStat*> out;
+    out.reserve(rule_stats_.size());
+    for (const auto& st : rule_stats_) out.push_back(st.get());
+    return out;
+}
+
+bool CommandRegistry::try_commands(const std::vector<Command>& cmds, const MessageContext& ctx, ReplyFrame& reply) const
+{
+    for (const auto& cmd : cmds) {
+        bool matched = false;
+        try {
+            matched = (!cmd.require_at || ctx.at_bot) && (!cmd.guard || cmd.guard(ctx));
+        } catch (const std::exception& e) {
+            write_log(LogLevel::Error, std::string("Rule matcher threw: ") + e.what());
+        } catch (...) {
+            write_log(LogLevel::Error, "Rule matcher threw: unknown exception");
+        }
+        if (!matched) continue;
+
+        try {
+            const auto started = steady_clock::now();
+            const std::string plain = cmd.handler(ctx);
+            const auto handled = steady_clock::now();
+            if (cmd.at_sender) {
+                reply.assign(ctx.group_id_str, with_at(ctx.user_id_str, plain));
+            } else {
+                reply.assign(ctx.group_id_str, plain);
+            }
+            pipeline_record_since(PipelineStage::ReplyBuild, handled);
+            if (cmd.latency != nullptr) {
+                cmd.latency->add(std::chrono::duration_cast<std::chrono::microseconds>(handled - started).count());
+            }
+            return true;
+        } catch (const std::exception& e) {
+            write_log(LogLevel::Error, std::string("Rule reply_generator threw: ") + e.what());
+        } catch (...) {
+            write_log(LogLevel::Error, "Rule reply_generator threw: unknown exception");
+        }
+    }
+    return false;
+}
+
+bool CommandRegistry::matches_text(const std::string& text) const
+{
+    if (exact_.count(text) != 0) return true;
+    for (std::size_t len : prefix_lengths_) {
+        if (len <= text.size() && prefix_.count(text.substr(0, len)) != 0) return true;
+    }
+    return false;
+}
+
+bool CommandRegistry::dispatch(const MessageContext& ctx, ReplyFrame& reply) const
+{
+    const std::string& content = ctx.text;
+    auto exact = exact_.find(content);
+    if (exact != exact_.end() && try_commands(exact->second, ctx, reply)) {
+        return true;
+    }
+    for (std::size_t len : prefix_lengths_) {
+        if (len > content.size()) continue;
+        auto it = prefix_.find(content.substr(0, len));
+        if (it != prefix_.end() && try_commands(it->second, ctx, reply)) {
+            return true;
+        }
+    }
+    return try_commands(predicates_, ctx, reply);
+}
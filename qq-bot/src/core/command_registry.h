@@ -0,0 +1,70 @@
+﻿#pragma once
+#ifndef COMMAND_REGISTRY_H
+#define COMMAND_REGISTRY_H
+
+#include "message_context.h"
+#include "reply_frame.h"
+#include "stats.h"
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 附加条件 / 谓词规则的匹配器（指令文本为 ctx.text）
+using CommandPredicate = std::function<bool(const MessageContext& ctx)>;
+// 回复生成器：返回回复文本（目标群为 ctx.group_id_str）
+using CommandHandler = std::function<std::string(const MessageContext& ctx)>;
+
+struct Command {
+    CommandHandler handler;
+    bool require_at = true;  // 需要 @机器人 才触发
+    bool at_sender = true;   // 回复前 @发送者
+    CommandPredicate guard;  // 可选附加条件（如 游戏进行中），为空表示无条件；谓词规则中即匹配器本身
+    Log2Histogram* latency = nullptr; // 回复生成耗时，注册时由指令表分配
+
+    Command() = default;
+    Command(CommandHandler h, bool need_at = true, bool reply_at = true)
+        : handler(std::move(h)), require_at(need_at), at_sender(reply_at) {}
+};
+
+// 指令表：启动时由各模块注册一次，此后只读，多线程可并发 dispatch
+// 匹配顺序：精确指令（哈希查找）→ 前缀指令（按已注册的不同前缀长度由长到短查找）→ 谓词规则（按注册顺序）
+// 前两类的开销与已注册的指令数无关；同一文本 / 前缀下的多条按注册顺序取第一条满足条件的
+class CommandRegistry {
+public:
+    // 每条指令一份耗时统计，以指令文本 / 前缀 / 给定名称命名
+    struct RuleStat {
+        std::string name;
+        Log2Histogram latency;
+    };
+
+    void add_exact(const std::string& text, Command cmd);
+    void add_prefix(const std::string& prefix, Command cmd);
+    void add_predicate(CommandPredicate matcher, Command cmd, const std::string& name = std::string());
+
+    // 匹配成功时把 send_group_msg 请求帧写入 reply 并返回 true
+    bool dispatch(const MessageContext& ctx, ReplyFrame& reply) const;
+
+    // 文本是否命中某条精确 / 前缀指令（不看 require_at 与附加条件，不执行指令），供入口按指令分级
+    bool matches_text(const std::string& text) const;
+
+    std::size_t size() const;
+
+    // 各指令的回复生成耗时（按注册顺序）
+    std::vector<const RuleStat*> rule_stats() const;
+
+private:
+    void attach_stat(Command& cmd, const std::string& name);
+
+    bool try_commands(const std::vector<Command>& cmds, const MessageContext& ctx, ReplyFrame& reply) const;
+
+    std::unordered_map<std::string, std::vector<Command>> exact_;
+    std::unordered_map<std::string, std::vector<Command>> prefix_;
+    std::vector<std::size_t> prefix_lengths_; // 由长到短、去重
+    std::vector<Command> predicates_;
+    std::vector<std::unique_ptr<RuleStat>> rule_stats_;
+};
+
+#endif // COMMAND_REGISTRY_H
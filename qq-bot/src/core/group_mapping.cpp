@@ -1,5 +1,6 @@
 ﻿#include "group_mapping.h"
 #include "utils.h"
+#include "command_registry.h"
 #include <nlohmann/json.hpp>
 #include <fstream>
 #include <map>
@@ -194,4 +195,53 @@ void clear_reminder_group()
     {
         write_log("Persist clear_reminder_group failed");
     }
-}
\ No newline at end of file
+}
+
+// 绑定类指令（无需 @）：设置提醒群 / 绑定群聊 / 取消绑定群聊 / 绑定群提醒 / 取消绑定群提醒
+void register_group_binding_commands(CommandRegistry& registry)
+{
+    registry.add_exact(u8"设置提醒群", Command{
+        [](const MessageContext& ctx) -> std::string
+        {
+            set_group_id_for_qq(ctx.user_id_str, ctx.group_id_str);
+            return u8"已绑定此群为你的每日课程提醒群（22:00 推送明日课程）。";
+        },
+        false });
+
+    Command bind_query{
+        [](const MessageContext& ctx) -> std::string
+        {
+            add_query_group(ctx.group_id_str);
+            return u8"✅ 已将本群绑定为查询群，可直接发送「有谁在上课」查看。";
+        },
+        false, false };
+    registry.add_exact(u8"绑定群聊", bind_query);
+
+    Command unbind_query{
+        [](const MessageContext& ctx) -> std::string
+        {
+            remove_query_group(ctx.group_id_str);
+            return u8"✅ 已取消本群的查询群绑定。";
+        },
+        false, false };
+    registry.add_exact(u8"取消绑定群聊", unbind_query);
+    registry.add_exact(u8"解绑群聊", unbind_query);
+
+    registry.add_exact(u8"绑定群提醒", Command{
+        [](const MessageContext& ctx) -> std::string
+        {
+            set_reminder_group(ctx.group_id_str);
+            return u8"✅ 已将本群设置为提醒群，将在每日22:00推送「明日课程」。";
+        },
+        false, false });
+
+    Command clear_reminder{
+        [](const MessageContext&) -> std::string
+        {
+            clear_reminder_group();
+            return u8"✅ 已取消提醒群设置。";
+        },
+        false, false };
+    registry.add_exact(u8"取消绑定群提醒", clear_reminder);
+    registry.add_exact(u8"解绑群提醒", clear_reminder);
+}
@@ -3,6 +3,8 @@
 #include <vector>
 #include <set>
 
+class CommandRegistry;
+
 // 初始化（加载持久化文件）
 bool init_group_mapping();
 
@@ -21,3 +23,6 @@ std::set<std::string> get_query_groups();
 void set_reminder_group(const std::string& group_id);
 std::string get_reminder_group();
 void clear_reminder_group();
+
+// 注册绑定类指令（设置提醒群 / 绑定群聊 / 绑定群提醒 及其取消）
+void register_group_binding_commands(CommandRegistry& registry);
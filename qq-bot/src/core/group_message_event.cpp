@@ -0,0 +1,202 @@
+﻿#include "group_message_event.h"
+#include "config.h"
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace {
+
+// 只关心顶层与 sender 对象内的少数字段，其余值只计深度不落地
+class GroupEventSax {
+public:
+    explicit GroupEventSax(GroupMessageEvent& ev) : ev_(ev) {}
+
+    bool null() { field_ = Field::None; return true; }
+    bool boolean(bool) { field_ = Field::None; return true; }
+    bool number_integer(json::number_integer_t v) { set_integer(static_cast<long long>(v)); return true; }
+    bool number_unsigned(json::number_unsigned_t v) { set_integer(static_cast<long long>(v)); return true; }
+    bool number_float(json::number_float_t, const json::string_t&) { field_ = Field::None; return true; }
+    bool binary(json::binary_t&) { field_ = Field::None; return true; }
+
+    bool string(json::string_t& val) {
+        if (in_segment_) {
+            segment_value(val);
+            return true;
+        }
+        switch (field_) {
+        case Field::RawMessage: ev_.raw_message.assign(val); ev_.has_raw_message = true; break;
+        case Field::Card: ev_.card.assign(val); break;
+        case Field::Nickname: ev_.nickname.assign(val); break;
+        default: break;
+        }
+        field_ = Field::None;
+        return true;
+    }
+
+    bool start_object(std::size_t) {
+        ++depth_;
+        if (depth_ == 2 && field_ == Field::Sender) in_sender_ = true;
+        if (depth_ == 3 && in_message_) {
+            in_segment_ = true;
+            seg_ = SegmentFields{};
+        }
+        field_ = Field::None;
+        return true;
+    }
+
+    bool end_object() {
+        if (depth_ == 2) in_sender_ = false;
+        if (depth_ == 3 && in_segment_) {
+            in_segment_ = false;
+            finish_segment();
+        }
+        --depth_;
+        return true;
+    }
+
+    bool start_array(std::size_t) {
+        ++depth_;
+        if (depth_ == 2 && field_ == Field::Message) {
+            in_message_ = true;
+            ev_.has_message_array = true;
+        }
+        field_ = Field::None;
+        return true;
+    }
+
+    bool end_array() {
+        if (depth_ == 2) in_message_ = false;
+        --depth_;
+        return true;
+    }
+
+    bool key(json::string_t& k) {
+        field_ = Field::None;
+        if (depth_ == 1) {
+            if (k == "group_id") field_ = Field::GroupId;
+            else if (k == "user_id") field_ = Field::UserId;
+            else if (k == "message_id") field_ = Field::MessageId;
+            else if (k == "raw_message") field_ = Field::RawMessage;
+            else if (k == "sender") field_ = Field::Sender;
+            else if (k == "message") field_ = Field::Message;
+        } else if (in_segment_) {
+            // 段对象 {"type": ..., "data": {...}}：type 在第 3 层，data 内的参数在第 4 层
+            if (depth_ == 3 && k == "type") field_ = Field::SegType;
+            else if (depth_ == 4) {
+                if (k == "text") field_ = Field::SegText;
+                else if (k == "qq") field_ = Field::SegQq;
+                else if (k == "file") field_ = Field::SegFile;
+                else if (k == "id") field_ = Field::SegId;
+            }
+        } else if (depth_ == 2 && in_sender_) {
+            if (k == "user_id") field_ = Field::SenderUserId;
+            else if (k == "card") field_ = Field::Card;
+            else if (k == "nickname") field_ = Field::Nickname;
+        }
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) {
+        return false;
+    }
+
+    // 顶层 user_id 优先，sender.user_id 仅作兜底
+    void finish() {
+        if (!ev_.has_user_id && has_sender_user_id_) {
+            ev_.user_id = sender_user_id_;
+            ev_.has_user_id = true;
+        }
+    }
+
+private:
+    enum class Field {
+        None, GroupId, UserId, MessageId, RawMessage, Sender, SenderUserId, Card, Nickname,
+        Message, SegType, SegText, SegQq, SegFile, SegId
+    };
+
+    // data 内参数可能先于 type 出现，整段读完后再按类型取主参数
+    struct SegmentFields {
+        std::string type, text, qq, file, id;
+    };
+
+    void segment_value(std::string& val) {
+        switch (field_) {
+        case Field::SegType: seg_.type.swap(val); break;
+        case Field::SegText: seg_.text.swap(val); break;
+        case Field::SegQq: seg_.qq.swap(val); break;
+        case Field::SegFile: seg_.file.swap(val); break;
+        case Field::SegId: seg_.id.swap(val); break;
+        default: break;
+        }
+        field_ = Field::None;
+    }
+
+    void finish_segment() {
+        CqArraySegment out;
+        switch (cq_type_from_name(seg_.type)) {
+        case CqType::Text: out.value.swap(seg_.text); break;
+        case CqType::At: out.value.swap(seg_.qq); break;
+        case CqType::Image: out.value.swap(seg_.file); break;
+        case CqType::Reply:
+        case CqType::Face: out.value.swap(seg_.id); break;
+        default: break;
+        }
+        out.type.swap(seg_.type);
+        ev_.message_segments.push_back(std::move(out));
+    }
+
+    void set_integer(long long v) {
+        if (in_segment_) { // 部分实现把 qq / id 以数字上报
+            std::string s = std::to_string(v);
+            segment_value(s);
+            return;
+        }
+        switch (field_) {
+        case Field::GroupId: ev_.group_id = v; ev_.has_group_id = true; break;
+        case Field::UserId: ev_.user_id = v; ev_.has_user_id = true; break;
+        case Field::MessageId: ev_.message_id = v; break;
+        case Field::SenderUserId: sender_user_id_ = v; has_sender_user_id_ = true; break;
+        default: break;
+        }
+        field_ = Field::None;
+    }
+
+    GroupMessageEvent& ev_;
+    int depth_ = 0;
+    bool in_sender_ = false;
+    bool in_message_ = false;
+    bool in_segment_ = false;
+    SegmentFields seg_;
+    Field field_ = Field::None;
+    long long sender_user_id_ = 0;
+    bool has_sender_user_id_ = false;
+};
+
+} // namespace
+
+bool decode_group_message_event(std::string_view text, GroupMessageEvent& out)
+{
+    out = GroupMessageEvent{};
+    GroupEventSax sax(out);
+    const bool ok = json::sax_parse(text.data(), text.data() + text.size(), &sax,
+        json::input_format_t::json, true, true);
+    if (ok) sax.finish();
+    return ok;
+}
+
+bool is_at_bot(const GroupMessageEvent& ev)
+{
+    if (ev.has_message_array) {
+        for (const auto& seg : ev.message_segments) {
+            if (seg.type == "at" && seg.value == BOT_QQ) return true;
+        }
+        return false;
+    }
+    // qq 参数后可能还有 name 等参数
+    static const std::string at_tag = "[CQ:at,qq=" + std::string(BOT_QQ);
+    for (size_t pos = ev.raw_message.find(at_tag); pos != std::string::npos; pos = ev.raw_message.find(at_tag, pos + 1)) {
+        const size_t next = pos + at_tag.size();
+        if (next < ev.raw_message.size() && (ev.raw_message[next] == ']' || ev.raw_message[next] == ',')) return true;
+    }
+    return false;
+}
@@ -0,0 +1,35 @@
+﻿#pragma once
+#ifndef GROUP_MESSAGE_EVENT_H
+#define GROUP_MESSAGE_EVENT_H
+
+#include "cq_code.h"
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 群消息事件：只保留业务用到的字段，由 SAX 解码一次填充，处理链全程传递该结构
+struct GroupMessageEvent {
+    long long group_id = 0;
+    long long user_id = 0;      // 顶层 user_id，缺失时取 sender.user_id
+    long long message_id = 0;
+    std::string raw_message;
+    std::string card;           // sender.card（群名片）
+    std::string nickname;       // sender.nickname
+    std::vector<CqArraySegment> message_segments; // message 为数组格式（NapCat array 上报）时的各段，已反转义
+
+    bool has_group_id = false;
+    bool has_user_id = false;
+    bool has_raw_message = false;
+    bool has_message_array = false;
+};
+
+// SAX 解码一帧群消息 JSON（UTF-8）：不构建 DOM，未用到的字段（font 等）直接跳过
+// message 为数组格式时逐段保留类型与主参数（text / qq / file / id），字符串格式的 message 与 raw_message 重复，跳过
+// 解析失败返回 false；字段缺失由 has_* 标记，交给处理层判断
+bool decode_group_message_event(std::string_view text, GroupMessageEvent& out);
+
+// 是否 @ 了机器人
+bool is_at_bot(const GroupMessageEvent& ev);
+
+#endif // GROUP_MESSAGE_EVENT_H
@@ -0,0 +1,172 @@
+﻿#include "ingress_queue.h"
+#include "utils.h"
+
+using steady_clock = std::chrono::steady_clock;
+
+namespace {
+
+const char* const kLaneNames[] = { "cmd", "game", "passive" };
+
+} // namespace
+
+IngressQueue::IngressQueue(std::size_t capacity, std::size_t high_water)
+    : capacity_(capacity == 0 ? 1 : capacity)
+    , high_water_(high_water == 0 || high_water > capacity_ ? capacity_ : high_water)
+{
+}
+
+std::size_t IngressQueue::effective_lane(const Group& g)
+{
+    std::size_t lane = 0;
+    while (lane < kLanes && g.lane_count[lane] == 0) ++lane;
+    return lane;
+}
+
+// 按组当前的优先级加入就绪队列尾部，旧条目随 ready_gen 变化而过期；调用方需持有 mtx_
+void IngressQueue::make_ready(long long key, Group& g)
+{
+    g.ready_lane = effective_lane(g);
+    ++g.ready_gen;
+    std::deque<ReadyEntry>& ready = ready_[g.ready_lane];
+    ready.push_back(ReadyEntry{ key, g.ready_gen });
+
+    // 低优先级长期得不到服务时，组在优先级间来回切换会留下过期条目：超过组数两倍时就地清理
+    if (ready.size() > 2 * groups_.size() + 64) {
+        std::deque<ReadyEntry> live;
+        for (const ReadyEntry& e : ready) {
+            auto it = groups_.find(e.key);
+            if (it != groups_.end() && it->second.ready_gen == e.gen) live.push_back(e);
+        }
+        ready.swap(live);
+    }
+}
+
+// 淘汰一条优先级低于 lane 的最旧任务（从最低优先级找起），调用方需持有 mtx_
+// 只在队列已满时发生，逐组查找的开销以容量为界
+bool IngressQueue::evict_lower_than(std::size_t lane)
+{
+    for (std::size_t victim = kLanes - 1; victim > lane; --victim) {
+        Group* oldest_group = nullptr;
+        long long oldest_key = 0;
+        std::deque<Item>::iterator oldest;
+        for (auto& kv : groups_) {
+            Group& g = kv.second;
+            if (g.lane_count[victim] == 0) continue;
+            for (auto it = g.items.begin(); it != g.items.end(); ++it) {
+                if (it->lane != victim) continue;
+                if (oldest_group == nullptr || it->seq < oldest->seq) {
+                    oldest_group = &g;
+                    oldest_key = kv.first;
+                    oldest = it;
+                }
+                break; // 组内第一项即该组此优先级最旧的一项
+            }
+        }
+        if (oldest_group == nullptr) continue;
+
+        oldest_group->items.erase(oldest);
+        --oldest_group->lane_count[victim];
+        --depth_;
+        evicted_[victim].fetch_add(1, std::memory_order_relaxed);
+        if (oldest_group->items.empty()) {
+            groups_.erase(oldest_key);
+        } else if (effective_lane(*oldest_group) != oldest_group->ready_lane) {
+            make_ready(oldest_key, *oldest_group);
+        }
+        return true;
+    }
+    return false;
+}
+
+bool IngressQueue::push(long long key, IngressPriority prio, std::function<void()> task)
+{
+    const std::size_t lane = static_cast<std::size_t>(prio);
+    std::lock_guard<std::mutex> lock(mtx_);
+
+    // 高水位以上：闲聊类任务直接丢弃，把处理能力留给指令与游戏
+    if (prio == IngressPriority::Passive && depth_ >= high_water_) {
+        shed_[lane].fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    // 已满：从最低优先级开始淘汰一条比自己低的最旧任务
+    if (depth_ >= capacity_ && !evict_lower_than(lane)) {
+        shed_[lane].fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    Group& g = groups_[key];
+    g.items.push_back(Item{ std::move(task), steady_clock::now(), lane, next_seq_++ });
+    ++g.lane_count[lane];
+    ++depth_;
+    // 新组，或新任务提高了组的优先级：重新排入就绪队列
+    if (lane < g.ready_lane) {
+        make_ready(key, g);
+    }
+    enqueued_[lane].fetch_add(1, std::memory_order_relaxed);
+    if (depth_ > max_depth_.load(std::memory_order_relaxed)) {
+        max_depth_.store(depth_, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+bool IngressQueue::run_one()
+{
+    Item item;
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        Group* g = nullptr;
+        long long key = 0;
+        for (std::size_t lane = 0; lane < kLanes && g == nullptr; ++lane) {
+            while (!ready_[lane].empty()) {
+                const ReadyEntry entry = ready_[lane].front();
+                ready_[lane].pop_front();
+                auto it = groups_.find(entry.key);
+                if (it == groups_.end() || it->second.ready_gen != entry.gen) continue; // 过期条目
+                g = &it->second;
+                key = entry.key;
+                break;
+            }
+        }
+        if (g == nullptr) return false; // 对应任务已被淘汰
+
+        // 组内按到达顺序取下一项；组内还有任务则排到同优先级的队尾，让其他组轮流执行
+        item = std::move(g->items.front());
+        g->items.pop_front();
+        --g->lane_count[item.lane];
+        --depth_;
+        if (g->items.empty()) {
+            groups_.erase(key);
+        } else {
+            make_ready(key, *g);
+        }
+    }
+    wait_[item.lane].add(std::chrono::duration_cast<std::chrono::microseconds>(steady_clock::now() - item.queued_at).count());
+    try {
+        item.task();
+    } catch (const std::exception& e) {
+        write_log(LogLevel::Error, std::string("Ingress task threw: ") + e.what());
+    } catch (...) {
+        write_log(LogLevel::Error, "Ingress task threw: unknown exception");
+    }
+    return true;
+}
+
+std::size_t IngressQueue::depth() const
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    return depth_;
+}
+
+std::string IngressQueue::stats() const
+{
+    std::string out = "ingress depth=" + std::to_string(depth()) + " max_depth="
+        + std::to_string(max_depth_.load(std::memory_order_relaxed));
+    for (std::size_t i = 0; i < kLanes; ++i) {
+        out += std::string(", ") + kLaneNames[i]
+            + " in=" + std::to_string(enqueued_[i].load(std::memory_order_relaxed))
+            + " shed=" + std::to_string(shed_[i].load(std::memory_order_relaxed))
+            + " evicted=" + std::to_string(evicted_[i].load(std::memory_order_relaxed))
+            + " wait " + wait_[i].summary();
+    }
+    return out;
+}
@@ -0,0 +1,87 @@
+﻿#pragma once
+#ifndef INGRESS_QUEUE_H
+#define INGRESS_QUEUE_H
+
+#include "stats.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// 入口优先级：数值越小越先处理
+enum class IngressPriority {
+    Command = 0,    // 指令（@机器人 或命中指令表的精确 / 前缀指令）、API 回执
+    Game = 1,       // 小游戏输入（猜数等，无需 @）
+    Passive = 2,    // 普通闲聊：只做 +1 统计、成员名片缓存与日志
+    Count
+};
+
+// 读循环与业务线程之间的有界队列
+// 按键（群号）分组：同一组内严格按到达顺序执行，优先级只用于决定先服务哪个组
+// （组的优先级取其排队任务中最高的一项，同优先级的组轮流各执行一项）
+// 深度超过高水位后直接丢弃新的 Passive 任务；达到容量上限时淘汰最旧的低优先级任务，无可淘汰则拒绝入队
+// 淘汰只从组内摘掉该项，组内其余任务的相对顺序不变
+class IngressQueue {
+public:
+    IngressQueue(std::size_t capacity, std::size_t high_water);
+
+    // 入队（读线程调用），返回 false 表示任务被丢弃
+    bool push(long long key, IngressPriority prio, std::function<void()> task);
+
+    // 取出并执行优先级最高的组的下一项（工作线程调用，须只有一个工作线程），队列为空返回 false
+    bool run_one();
+
+    std::size_t depth() const;
+
+    // 统计摘要：各优先级入队 / 丢弃数、当前与最大深度、排队等待时间
+    std::string stats() const;
+
+private:
+    static constexpr std::size_t kLanes = static_cast<std::size_t>(IngressPriority::Count);
+
+    struct Item {
+        std::function<void()> task;
+        std::chrono::steady_clock::time_point queued_at;
+        std::size_t lane = 0;
+        unsigned long long seq = 0; // 全局到达序号，淘汰时用于找最旧的一项
+    };
+
+    // 一个组的排队任务（到达顺序）；ready_lane / ready_gen 标识它在就绪队列中的有效条目
+    struct Group {
+        std::deque<Item> items;
+        std::size_t lane_count[kLanes] = {};
+        std::size_t ready_lane = kLanes;
+        unsigned long long ready_gen = 0;
+    };
+
+    // 就绪队列条目：gen 与组当前的 ready_gen 不一致（组的优先级变了）或组已不存在时视为过期，出队时跳过
+    struct ReadyEntry {
+        long long key;
+        unsigned long long gen;
+    };
+
+    static std::size_t effective_lane(const Group& g);
+    void make_ready(long long key, Group& g);
+    bool evict_lower_than(std::size_t lane);
+
+    const std::size_t capacity_;
+    const std::size_t high_water_;
+
+    mutable std::mutex mtx_;
+    std::unordered_map<long long, Group> groups_;
+    std::deque<ReadyEntry> ready_[kLanes];
+    std::size_t depth_ = 0;
+    unsigned long long next_seq_ = 0;
+
+    std::atomic<std::size_t> max_depth_{ 0 };
+    std::atomic<unsigned long long> enqueued_[kLanes] = {};
+    std::atomic<unsigned long long> shed_[kLanes] = {};     // 高水位 / 满队列时被拒绝入队
+    std::atomic<unsigned long long> evicted_[kLanes] = {};  // 已入队后被更高优先级任务挤掉
+    LatencyStat wait_[kLanes];
+};
+
+#endif // INGRESS_QUEUE_H
@@ -1,13 +1,16 @@
 ﻿#include "member_cache.h"
 #include <map>
 #include <fstream>
+#include <mutex>
 
 static const char* MEMBER_NAME_FILE = "group_member_names.json";
 
 // group_id -> (qq -> name)
+// 各分片线程、提醒任务与成员列表回调都会读写，统一由 g_names_mtx 保护（*_locked 函数要求调用方已持锁）
 static std::map<std::string, std::map<std::string, std::string>> g_names;
+static std::mutex g_names_mtx;
 
-static void load_from_file()
+static void load_from_file_locked()
 {
     g_names.clear();
     std::ifstream ifs(MEMBER_NAME_FILE, std::ios::in | std::ios::binary);
@@ -34,7 +37,7 @@ static void load_from_file()
     }
 }
 
-static void save_to_file()
+static void save_to_file_locked()
 {
     nlohmann::json j = nlohmann::json::object();
     for (const auto& g : g_names) {
@@ -52,43 +55,21 @@ static void save_to_file()
 
 void init_member_cache()
 {
-    load_from_file();
+    std::lock_guard<std::mutex> lock(g_names_mtx);
+    load_from_file_locked();
     write_log("Member cache initialized, groups: " + std::to_string(g_names.size()));
 }
 
-void update_member_display_name(const json& msg_data)
+void update_member_display_name(const MessageContext& ctx)
 {
     try {
-        if (!msg_data.contains("group_id") || !msg_data["group_id"].is_number()) return;
-        std::string group_id = std::to_string(msg_data["group_id"].get<long long>());
-
-        std::string qq;
-        if (msg_data.contains("user_id") && msg_data["user_id"].is_number()) {
-            qq = std::to_string(msg_data["user_id"].get<long long>());
-        } else if (msg_data.contains("sender") && msg_data["sender"].is_object()
-                   && msg_data["sender"].contains("user_id") && msg_data["sender"]["user_id"].is_number()) {
-            qq = std::to_string(msg_data["sender"]["user_id"].get<long long>());
-        } else {
-            return;
-        }
-
-        std::string name;
-        if (msg_data.contains("sender") && msg_data["sender"].is_object()) {
-            const auto& s = msg_data["sender"];
-            if (s.contains("card") && s["card"].is_string()) {
-                name = trim_space(s["card"].get<std::string>());
-            }
-            if (name.empty() && s.contains("nickname") && s["nickname"].is_string()) {
-                name = trim_space(s["nickname"].get<std::string>());
-            }
-        }
-        if (name.empty()) name = qq;
-
-        auto& by_group = g_names[group_id];
-        auto it = by_group.find(qq);
-        if (it == by_group.end() || it->second != name) {
-            by_group[qq] = name;
-            save_to_file();
+        std::lock_guard<std::mutex> lock(g_names_mtx);
+        // 显示名已在构建上下文时按 群名片 → 昵称 → QQ 取好
+        auto& by_group = g_names[ctx.group_id_str];
+        auto it = by_group.find(ctx.user_id_str);
+        if (it == by_group.end() || it->second != ctx.sender_name) {
+            by_group[ctx.user_id_str] = ctx.sender_name;
+            save_to_file_locked();
         }
     } catch (...) {
         // ignore
@@ -97,6 +78,7 @@ void update_member_display_name(const json& msg_data)
 
 std::string get_display_name(const std::string& group_id, const std::string& qq)
 {
+    std::lock_guard<std::mutex> lock(g_names_mtx);
     auto g_it = g_names.find(group_id);
     if (g_it == g_names.end()) return qq;
     auto u_it = g_it->second.find(qq);
@@ -106,11 +88,12 @@ std::string get_display_name(const std::string& group_id, const std::string& qq)
 
 void upsert_member_name(const std::string& group_id, const std::string& qq, const std::string& name)
 {
+    std::lock_guard<std::mutex> lock(g_names_mtx);
     auto& by_group = g_names[group_id];
     auto it = by_group.find(qq);
     if (it == by_group.end() || it->second != name) {
         by_group[qq] = name.empty() ? qq : name;
-        save_to_file();
+        save_to_file_locked();
     }
 }
 
@@ -118,6 +101,7 @@ void upsert_member_name(const std::string& group_id, const std::string& qq, cons
 std::vector<std::string> get_group_member_qqs(const std::string& group_id)
 {
     std::vector<std::string> result;
+    std::lock_guard<std::mutex> lock(g_names_mtx);
     auto it = g_names.find(group_id);
     if (it == g_names.end()) return result;
     result.reserve(it->second.size());
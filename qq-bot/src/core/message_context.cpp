@@ -0,0 +1,71 @@
+﻿#include "message_context.h"
+#include "config.h"
+#include "text_normalize.h"
+#include "utils.h"
+
+void unaddressed_command_text(const GroupMessageEvent& ev, std::string& out)
+{
+    if (!ev.has_message_array) {
+        normalize_text_into(ev.raw_message, out, true);
+        return;
+    }
+    // 与 make_message_context 相同：只拼接文本段，不做实体解码
+    thread_local std::string joined;
+    joined.clear();
+    for (const auto& seg : ev.message_segments) {
+        if (seg.type == "text") joined.append(seg.value);
+    }
+    normalize_text_into(joined, out, false);
+}
+
+MessageContext make_message_context(const GroupMessageEvent& ev)
+{
+    MessageContext ctx;
+    ctx.group_id = ev.group_id;
+    ctx.user_id = ev.user_id;
+    ctx.message_id = ev.message_id;
+    ctx.group_id_str = std::to_string(ev.group_id);
+    ctx.user_id_str = std::to_string(ev.user_id);
+    ctx.raw_message = ev.raw_message;
+
+    // 消息段只切分一次：@ 判断、指令正文与 +1 检测共用
+    if (ev.has_message_array) {
+        cq_segments_from_array(ev.message_segments, ctx.segments);
+    } else {
+        cq_tokenize(ctx.raw_message, ctx.segments);
+    }
+
+    // 第一个 @机器人 的段之后即为指令正文（qq 参数之外的 name 等参数不影响判断）
+    size_t at_index = ctx.segments.size();
+    for (size_t i = 0; i < ctx.segments.size(); ++i) {
+        if (ctx.segments[i].type == CqType::At && ctx.segments[i].value == BOT_QQ) {
+            at_index = i;
+            break;
+        }
+    }
+    ctx.at_bot = at_index < ctx.segments.size();
+
+    if (!ev.has_message_array) {
+        if (ctx.at_bot) {
+            const std::string_view at_raw = ctx.segments[at_index].raw;
+            ctx.body = ctx.raw_message.substr(static_cast<size_t>(at_raw.data() - ctx.raw_message.data()) + at_raw.size());
+        } else {
+            ctx.body = ctx.raw_message;
+        }
+        normalize_text_into(ctx.body, ctx.text, true);
+    } else {
+        // 拼接缓冲按线程复用，避免每条消息重新分配
+        thread_local std::string joined;
+        joined.clear();
+        for (size_t i = ctx.at_bot ? at_index + 1 : 0; i < ctx.segments.size(); ++i) {
+            if (ctx.segments[i].type == CqType::Text) joined.append(ctx.segments[i].value);
+        }
+        ctx.body = ctx.raw_message;
+        normalize_text_into(joined, ctx.text, false);
+    }
+
+    ctx.sender_name = trim_space(ev.card);
+    if (ctx.sender_name.empty()) ctx.sender_name = trim_space(ev.nickname);
+    if (ctx.sender_name.empty()) ctx.sender_name = ctx.user_id_str;
+    return ctx;
+}
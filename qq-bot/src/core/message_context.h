@@ -0,0 +1,34 @@
+﻿#pragma once
+#ifndef MESSAGE_CONTEXT_H
+#define MESSAGE_CONTEXT_H
+
+#include "group_message_event.h"
+#include "cq_code.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 单条群消息的处理上下文：每条消息构建一次，指令匹配 / 回复生成 / +1 检测 / 成员缓存共用
+struct MessageContext {
+    long long group_id = 0;
+    long long user_id = 0;
+    long long message_id = 0;
+    std::string group_id_str;       // 群号字符串（回复与各模块按群存储的键）
+    std::string user_id_str;        // 发送者 QQ 字符串
+    bool at_bot = false;            // 是否 @ 了机器人
+    std::string_view raw_message;   // 原始消息，指向事件内的 raw_message（事件须比上下文活得久）
+    std::vector<CqSegment> segments; // 消息段视图（数组格式上报时来自 message 数组，否则切分 raw_message），同样指向事件
+    std::string_view body;          // raw_message 去掉 @机器人 及其之前部分（未 @ 或数组格式时同 raw_message）
+    std::string text;               // 指令匹配用文本：@机器人 之后的内容规范化（去不可见字符、trim、实体解码）
+                                    // 数组格式只拼接其后的文本段，且文本未经 CQ 转义，不再做实体解码
+    std::string sender_name;        // 群名片 → 昵称 → QQ（已去首尾空白）
+};
+
+// 由群消息事件构建上下文（调用方须先确认 has_group_id / has_user_id / has_raw_message）
+MessageContext make_message_context(const GroupMessageEvent& ev);
+
+// 未 @机器人 的消息的指令匹配文本（与 make_message_context 对该消息得到的 ctx.text 相同），写入 out
+// 供入口分级在解码后、构建上下文之前判断消息是否为无需 @ 的指令
+void unaddressed_command_text(const GroupMessageEvent& ev, std::string& out);
+
+#endif // MESSAGE_CONTEXT_H
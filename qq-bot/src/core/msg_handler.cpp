@@ -2,249 +2,102 @@
 #include "utils.h"
 #include "config.h"
 #include <iostream>
-#include <boost/asio/buffer.hpp>
 #include <vector>
 #include <functional>
+#include "command_registry.h"
+#include "message_context.h"
 #include "reply_generator.h"
-#include "guess_number.h"
 #include "schedule.h"
-#include "schedule_loader.h"
-#include "group_mapping.h"
+#include "guess_number.h"
 #include "class_inquiry.h"
+#include "group_mapping.h"
 #include "member_cache.h" // + 引入
 #include "plusone_kill.h" 
+#include "outbound_scheduler.h"
+#include "pipeline_stats.h"
+#include "status_command.h"
 
-// 线程局部保存当前 sender_qq，供规则内部调用
-static thread_local std::string g_current_sender_qq;
-const std::string& get_current_sender_qq() { return g_current_sender_qq; }
-
-struct KeywordRule {
-    std::function<bool(const json&, const std::string&)> matcher;
-    std::function<std::string(const std::string&)> reply_generator;
-};
+static CommandRegistry g_registry;
 
-static std::string decode_html_entities(const std::string& s)
+void init_command_registry()
 {
-    std::string out = s;
-    auto replace_all = [&](const char* from, const char* to)
-    {
-        std::string f(from);
-        std::string t(to);
-        std::size_t pos = 0;
-        while ((pos = out.find(f, pos)) != std::string::npos)
-        {
-            out.replace(pos, f.length(), t);
-            pos += t.length();
-        }
-    };
-    // 最常用的实体
-    replace_all("&#91;", "[");   // 修正：原来是 "[]"
-    replace_all("&#93;", "]");
-    replace_all("&quot;", "\"");
-    replace_all("&amp;", "&");
-    replace_all("&#123;", "{");
-    replace_all("&#125;", "}");
-    return out;
+    // 注册顺序即同名指令 / 谓词规则的优先顺序，与原先逐组尝试规则的顺序一致
+    register_default_commands(g_registry);
+    register_schedule_commands(g_registry);
+    register_guess_number_commands(g_registry);
+    register_class_inquiry_commands(g_registry);
+    register_group_binding_commands(g_registry);
+    register_status_commands(g_registry);
+    write_log("Command registry built: " + std::to_string(g_registry.size()) + " commands");
 }
 
-// 规范化文本：去除常见不可见字符、BOM、NBSP、全角空格，最终再 trim
-static std::string normalize_text(const std::string& s) {
-    std::string out;
-    out.reserve(s.size());
-    for (unsigned char c : s) {
-        if (c < 32 || c == 127) continue; // 去除ASCII控制字符
-        out.push_back(static_cast<char>(c));
-    }
-    auto erase_seq = [&](const char* seq, size_t len) {
-        for (;;) {
-            auto pos = out.find(std::string(seq, len));
-            if (pos == std::string::npos) break;
-            out.erase(pos, len);
-        }
-        };
-    // U+FEFF BOM, U+200B 零宽空格, U+00A0 NBSP, U+3000 全角空格
-    erase_seq("\xEF\xBB\xBF", 3);
-    erase_seq("\xE2\x80\x8B", 3);
-    erase_seq("\xC2\xA0", 2);
-    erase_seq("\xE3\x80\x80", 3);
-    out = trim_space(out);
-    out = decode_html_entities(out); // 追加实体解码
-    return out;
+const CommandRegistry& command_registry()
+{
+    return g_registry;
 }
 
-
-
-void handle_group_message(const json& msg_data, websocket::stream<tcp_socket>& ws) {
+static void reply_to_message(const MessageContext& ctx) {
     try {
-        if (!msg_data.contains("group_id") || !msg_data["group_id"].is_number()) {
-            write_log("Ignore invalid message: No group_id or wrong type");
-            return;
-        }
-        std::string group_id = std::to_string(msg_data["group_id"].get<long long>());
-        // 2. 验证并获取发送者QQ号（新增核心逻辑）
-        std::string sender_qq;
-        if (msg_data.contains("user_id") && msg_data["user_id"].is_number()) {
-            // 直接获取user_id（大部分CQHTTP协议的字段）
-            sender_qq = std::to_string(msg_data["user_id"].get<long long>());
+        const std::string& group_id = ctx.group_id_str;
+        // 每条群消息一行且带全文，按采样间隔记录（LOG_SAMPLE_RECEIVED_EVERY）
+        if (log_sampled(LogCategory::Received)) {
+            write_log("Received message from group " + group_id + " qq号：" + ctx.user_id_str + ": " + std::string(ctx.body) + " (trimmed: " + ctx.text + ")");
         }
-        else if (msg_data.contains("sender") && msg_data["sender"].is_object() &&
-            msg_data["sender"].contains("user_id") && msg_data["sender"]["user_id"].is_number()) {
-            // 兼容嵌套在sender对象中的情况
-            sender_qq = std::to_string(msg_data["sender"]["user_id"].get<long long>());
-        }
-        else {
-            write_log("Ignore invalid message: No sender QQ (user_id) or wrong type");
-            return;
-        }
-
-        // 将当前 sender_qq 暴露给规则层
-        g_current_sender_qq = sender_qq;
-
-        if (!msg_data.contains("raw_message") || !msg_data["raw_message"].is_string()) {
-            write_log("Ignore invalid message: No raw_message or wrong type");
-            return;
-        }
-        std::string raw_msg = msg_data["raw_message"].get<std::string>();
-
-        std::string at_tag = "[CQ:at,qq=" + std::string(BOT_QQ) + "]";
-        size_t at_pos = raw_msg.find(at_tag);
-        if (at_pos != std::string::npos) {
-            raw_msg = raw_msg.substr(at_pos + at_tag.length());
-        }
-
-        std::string trimmed_msg = normalize_text(raw_msg);
-
-        write_log("Received message from group " + group_id + " qq号：" + sender_qq + ": " + raw_msg + " (trimmed: " + trimmed_msg + ")");
 
-        json reply;
+        ReplyFrame reply;
         bool need_reply = false;
 
-        // 步骤1：先尝试默认规则（1/hello/你好）
-        need_reply = ReplyGenerator::generate(msg_data, trimmed_msg, group_id, reply);
-
-        // 步骤2：课表相关规则（导入/查询/清空/今日课程/设置学期 等）
-        if (!need_reply) {
-            std::vector<ReplyRule> schedule_rules = Schedule().get_schedule_rules();
-            need_reply = ReplyGenerator::generate_with_rules(msg_data, trimmed_msg, group_id, schedule_rules, reply);
-        }
+        // 步骤1-4：指令表（默认 / 课表 / 猜数 / 上课查询 / 绑定类指令，启动时构建一次）
+        const auto dispatch_start = std::chrono::steady_clock::now();
+        need_reply = g_registry.dispatch(ctx, reply);
+        pipeline_record_since(PipelineStage::Dispatch, dispatch_start);
 
-        // 步骤3：尝试猜数游戏规则
-        if (!need_reply) {
-            std::vector<ReplyRule> guess_rules = get_guess_number_rules();
-            need_reply = ReplyGenerator::generate_with_rules(msg_data, trimmed_msg, group_id, guess_rules, reply);
-        }
-        // 步骤4：尝试"有谁在上课"查询规则
-        if (!need_reply) {
-            std::vector<ReplyRule> class_inquiry_rules = get_class_inquiry_rules();
-            need_reply = ReplyGenerator::generate_with_rules(msg_data, trimmed_msg, group_id, class_inquiry_rules, reply);
-        }
-
-        // 新增指令处理
-        if (!need_reply) {
-            if (trimmed_msg == "设置提醒群") {
-                set_group_id_for_qq(sender_qq, group_id);
-                json reply_msg = {
-                    {"action", "send_group_msg"},
-                    {"params", {
-                        {"group_id", group_id},
-                        {"message", "[CQ:at,qq=" + sender_qq + "] 已绑定此群为你的每日课程提醒群（22:00 推送明日课程）。"}
-                    }}
-                };
-                reply = reply_msg;
-                need_reply = true;
-            } else if (trimmed_msg == "绑定群聊") {
-                add_query_group(group_id);
-                json reply_msg = {
-                    {"action", "send_group_msg"},
-                    {"params", {
-                        {"group_id", group_id},
-                        {"message", "✅ 已将本群绑定为查询群，可直接发送「有谁在上课」查看。"},
-                        {"auto_escape", false}
-                    }}
-                };
-                reply = reply_msg;
-                need_reply = true;
-            } else if (trimmed_msg == "取消绑定群聊" || trimmed_msg == "解绑群聊") {
-                remove_query_group(group_id);
-                json reply_msg = {
-                    {"action", "send_group_msg"},
-                    {"params", {
-                        {"group_id", group_id},
-                        {"message", "✅ 已取消本群的查询群绑定。"},
-                        {"auto_escape", false}
-                    }}
-                };
-                reply = reply_msg;
-                need_reply = true;
-            } else if (trimmed_msg == "绑定群提醒") {
-                set_reminder_group(group_id);
-                json reply_msg = {
-                    {"action", "send_group_msg"},
-                    {"params", {
-                        {"group_id", group_id},
-                        {"message", "✅ 已将本群设置为提醒群，将在每日22:00推送「明日课程」。"},
-                        {"auto_escape", false}
-                    }}
-                };
-                reply = reply_msg;
-                need_reply = true;
-            } else if (trimmed_msg == "取消绑定群提醒" || trimmed_msg == "解绑群提醒") {
-                clear_reminder_group();
-                json reply_msg = {
-                    {"action", "send_group_msg"},
-                    {"params", {
-                        {"group_id", group_id},
-                        {"message", "✅ 已取消提醒群设置。"},
-                        {"auto_escape", false}
-                    }}
-                };
-                reply = reply_msg;
-                need_reply = true;
-            }
-        }
         // 步骤5：检测是否连续发送三次相同原始消息（包括CQ码），触发表情包回复
         if (!need_reply) {
-            std::string raw_content = msg_data["raw_message"].get<std::string>();
-            if (PlusOneKill::HandleMessage(group_id, sender_qq, raw_content, msg_data, reply)) {
+            if (PlusOneKill::HandleMessage(ctx, reply)) {
                 need_reply = true;
             }
         }
 
         // 发送
         if (need_reply) {
-            std::string reply_str = reply.dump();
-            ws.write(boost::asio::buffer(reply_str));
-
-            // 安全输出日志：message 可能是字符串，也可能是数组/对象
-            std::string msg_log;
-            try {
-                const auto &params = reply.at("params");
-                if (params.contains("message")) {
-                    const auto &m = params["message"];
-                    if (m.is_string()) {
-                        msg_log = m.get<std::string>();
-                    } else {
-                        msg_log = m.dump();
-                    }
-                }
-            } catch (...) {
-                msg_log = "<invalid message field>";
-            }
-
-            write_log("Replied to group " + group_id + ": " + msg_log);
+            // 先记日志再移交：帧交给出站调度后由发送路径持有
+            write_log("Replied to group " + group_id + ": " + std::string(reply.message()));
+            outbound_send(std::move(reply), SendLane::Interactive); // 经限速调度发出，先于批量提醒
         }
-        else {
-            write_log("Group " + group_id + ": Message does not meet reply conditions, ignored");
+        else if (log_enabled(LogLevel::Debug)) {
+            write_log(LogLevel::Debug, "Group " + group_id + ": Message does not meet reply conditions, ignored");
         }
     }
     catch (const json::exception& e) {
-        write_log("JSON error: " + std::string(e.what()) + ", Error id: " + std::to_string(e.id));
-    }
-    catch (const boost::beast::system_error& e) {
-        write_log("WebSocket error: " + std::string(e.what()) + ", Error code: " + std::to_string(e.code().value()));
+        write_log(LogLevel::Error, "JSON error: " + std::string(e.what()) + ", Error id: " + std::to_string(e.id));
     }
     catch (const std::exception& e) {
-        write_log("General error: " + std::string(e.what()));
+        write_log(LogLevel::Error, "General error: " + std::string(e.what()));
     }
-    update_member_display_name(msg_data);
+}
+
+void handle_group_message(const GroupMessageEvent& ev) {
+    if (!ev.has_group_id) {
+        write_log("Ignore invalid message: No group_id or wrong type");
+        return;
+    }
+    // 发送者QQ号（解码时已兼容嵌套在 sender 对象中的情况）
+    if (!ev.has_user_id) {
+        write_log("Ignore invalid message: No sender QQ (user_id) or wrong type");
+        return;
+    }
+    // 无 raw_message 的事件整条忽略，也不更新成员缓存
+    if (!ev.has_raw_message) {
+        write_log("Ignore invalid message: No raw_message or wrong type");
+        return;
+    }
+
+    // 每条消息只构建一次上下文，指令匹配、回复生成、+1 检测与成员缓存共用
+    pipeline_count_message();
+    const auto normalize_start = std::chrono::steady_clock::now();
+    const MessageContext ctx = make_message_context(ev);
+    pipeline_record_since(PipelineStage::Normalize, normalize_start);
+    reply_to_message(ctx);
+    update_member_display_name(ctx);
 }
\ No newline at end of file
@@ -1,21 +1,20 @@
 ﻿#ifndef GROUP_MSG_H
 #define GROUP_MSG_H
 
+#include "group_message_event.h"
+#include "command_registry.h"
 #include <nlohmann/json.hpp>
-#include <boost/beast/websocket.hpp>
-#include <boost/asio/ip/tcp.hpp>
 #include <string>
 
 using json = nlohmann::json;
-namespace websocket = boost::beast::websocket;
-using tcp_socket = boost::asio::ip::tcp::socket;
 
-// 处理群消息（核心业务逻辑）
-void handle_group_message(const json& msg_data, websocket::stream<tcp_socket>& ws);
-//接受关键词并且回复
-bool generate_reply(const json& msg_data, const std::string& trimmed_msg, const std::string& group_id, json& reply);
+// 处理群消息（核心业务逻辑），回复经发送队列异步写出
+void handle_group_message(const GroupMessageEvent& ev);
 
-// 获取当前正在处理消息的 sender_qq（线程局部）
-const std::string& get_current_sender_qq();
+// 启动时构建全局指令表（只需调用一次，须在处理消息前完成）
+void init_command_registry();
+
+// 全局指令表（只读）
+const CommandRegistry& command_registry();
 
 #endif // GROUP_MSG_H#pragma once
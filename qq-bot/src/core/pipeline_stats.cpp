@@ -0,0 +1,82 @@
+﻿#include "pipeline_stats.h"
+#include <atomic>
+
+using steady_clock = std::chrono::steady_clock;
+
+namespace {
+
+constexpr std::size_t kStages = static_cast<std::size_t>(PipelineStage::Count);
+constexpr int kRateSlots = 60;
+
+const char* const kStageNames[kStages] = {
+    u8"读取", u8"解析", u8"排队", u8"规范化", u8"指令匹配", u8"回复构建", u8"端到端处理", u8"限速等待", u8"发送"
+};
+
+Log2Histogram g_stages[kStages];
+std::atomic<unsigned long long> g_messages{ 0 };
+const steady_clock::time_point g_started = steady_clock::now();
+
+// 最近 60 秒每秒的消息数：槽位按秒轮转，槽位所属的秒数单独记录，过期的槽位在写入或读取时视为 0
+std::atomic<long long> g_slot_sec[kRateSlots];
+std::atomic<unsigned long long> g_slot_count[kRateSlots];
+
+long long now_sec() {
+    return std::chrono::duration_cast<std::chrono::seconds>(steady_clock::now() - g_started).count();
+}
+
+} // namespace
+
+void pipeline_record(PipelineStage stage, long long micros)
+{
+    g_stages[static_cast<std::size_t>(stage)].add(micros);
+}
+
+const Log2Histogram& pipeline_histogram(PipelineStage stage)
+{
+    return g_stages[static_cast<std::size_t>(stage)];
+}
+
+const char* pipeline_stage_name(PipelineStage stage)
+{
+    return kStageNames[static_cast<std::size_t>(stage)];
+}
+
+void pipeline_count_message()
+{
+    g_messages.fetch_add(1, std::memory_order_relaxed);
+    const long long sec = now_sec();
+    const int slot = static_cast<int>(sec % kRateSlots);
+    long long owner = g_slot_sec[slot].load(std::memory_order_relaxed);
+    if (owner != sec && g_slot_sec[slot].compare_exchange_strong(owner, sec, std::memory_order_relaxed)) {
+        g_slot_count[slot].store(0, std::memory_order_relaxed); // 新的一秒占用该槽位（与并发写入的竞争只影响统计精度）
+    }
+    g_slot_count[slot].fetch_add(1, std::memory_order_relaxed);
+}
+
+unsigned long long pipeline_message_total()
+{
+    return g_messages.load(std::memory_order_relaxed);
+}
+
+double pipeline_message_rate(int window_sec)
+{
+    if (window_sec <= 0) return 0.0;
+    if (window_sec > kRateSlots - 1) window_sec = kRateSlots - 1;
+    // 不含当前这一秒（尚未结束）
+    const long long now = now_sec();
+    unsigned long long total = 0;
+    for (long long sec = now - window_sec; sec < now; ++sec) {
+        if (sec < 0) continue;
+        const int slot = static_cast<int>(sec % kRateSlots);
+        if (g_slot_sec[slot].load(std::memory_order_relaxed) == sec) {
+            total += g_slot_count[slot].load(std::memory_order_relaxed);
+        }
+    }
+    const long long span = now < window_sec ? now : window_sec;
+    return span <= 0 ? 0.0 : static_cast<double>(total) / static_cast<double>(span);
+}
+
+long long pipeline_uptime_sec()
+{
+    return now_sec();
+}
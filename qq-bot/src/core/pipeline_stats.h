@@ -0,0 +1,43 @@
+﻿#pragma once
+#ifndef PIPELINE_STATS_H
+#define PIPELINE_STATS_H
+
+#include "stats.h"
+#include <chrono>
+#include <string>
+
+// 群消息处理链各阶段耗时（微秒），每阶段一个对数分桶直方图，进程内只增不清零
+enum class PipelineStage {
+    Read,       // 首字节到达 -> 整帧读完（io 线程）
+    Parse,      // 预分类 + SAX 解码
+    Queue,      // 读完 -> 分片线程开始处理（含入口队列排队）
+    Normalize,  // 构建 MessageContext（CQ 码切分、文本规范化）
+    Dispatch,   // 指令表匹配 + 回复生成（含下面的 ReplyBuild）
+    ReplyBuild, // 写出 send_group_msg 请求帧
+    Handle,     // 读完 -> 分片线程处理完毕（端到端，不含出站限速与发送）
+    Throttle,   // 提交出站 -> 令牌桶放行
+    Send,       // 进入发送队列 -> ws 写完成
+    Count
+};
+
+void pipeline_record(PipelineStage stage, long long micros);
+
+inline void pipeline_record_since(PipelineStage stage, std::chrono::steady_clock::time_point start) {
+    pipeline_record(stage, std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+const Log2Histogram& pipeline_histogram(PipelineStage stage);
+
+// 阶段名（用于状态回复）
+const char* pipeline_stage_name(PipelineStage stage);
+
+// 每处理一条群消息计数一次，用于计算消息速率
+void pipeline_count_message();
+
+// 累计处理的群消息数、最近 window_sec 秒（不超过 60）的平均速率（条/秒）、进程启动以来的秒数
+unsigned long long pipeline_message_total();
+double pipeline_message_rate(int window_sec);
+long long pipeline_uptime_sec();
+
+#endif // PIPELINE_STATS_H
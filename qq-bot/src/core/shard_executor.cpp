@@ -0,0 +1,94 @@
+﻿#include "shard_executor.h"
+#include "utils.h"
+
+namespace {
+
+thread_local int t_current_shard = -1;
+
+} // namespace
+
+ShardExecutor::ShardExecutor(std::size_t shards, std::size_t capacity, std::size_t high_water)
+{
+    if (shards == 0) shards = std::thread::hardware_concurrency();
+    if (shards == 0) shards = 1;
+    shards_.reserve(shards);
+    for (std::size_t i = 0; i < shards; ++i) {
+        shards_.push_back(std::make_unique<Shard>(capacity, high_water));
+    }
+    for (std::size_t i = 0; i < shards; ++i) {
+        shards_[i]->thread = std::thread([this, i]() { run(i); });
+    }
+}
+
+ShardExecutor::~ShardExecutor()
+{
+    stop();
+}
+
+std::size_t ShardExecutor::shard_of(long long key) const
+{
+    // 群号本身分布不均（同一号段居多），先做一次乘法散列再取模
+    unsigned long long h = static_cast<unsigned long long>(key) * 0x9E3779B97F4A7C15ULL;
+    h ^= h >> 32;
+    return static_cast<std::size_t>(h % shards_.size());
+}
+
+bool ShardExecutor::post(long long key, IngressPriority prio, std::function<void()> task)
+{
+    Shard& shard = *shards_[shard_of(key)];
+    {
+        // 入队与检查停止标志在分片锁内完成：分片线程在同一把锁下判断队列深度并进入等待，不会错过唤醒
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        if (shard.stopping || !shard.queue.push(key, prio, std::move(task))) return false;
+    }
+    shard.cv.notify_one();
+    return true;
+}
+
+void ShardExecutor::stop()
+{
+    for (auto& shard : shards_) {
+        {
+            std::lock_guard<std::mutex> lock(shard->mtx);
+            shard->stopping = true;
+        }
+        shard->cv.notify_one();
+    }
+    for (auto& shard : shards_) {
+        if (shard->thread.joinable()) shard->thread.join();
+    }
+}
+
+int ShardExecutor::current_shard()
+{
+    return t_current_shard;
+}
+
+void ShardExecutor::run(std::size_t index)
+{
+    t_current_shard = static_cast<int>(index);
+    Shard& shard = *shards_[index];
+    for (;;) {
+        while (shard.queue.run_one()) {
+        }
+        std::unique_lock<std::mutex> lock(shard.mtx);
+        shard.cv.wait(lock, [&shard]() { return shard.stopping || shard.queue.depth() > 0; });
+        if (shard.stopping && shard.queue.depth() == 0) break;
+    }
+}
+
+std::size_t ShardExecutor::depth() const
+{
+    std::size_t total = 0;
+    for (const auto& shard : shards_) total += shard->queue.depth();
+    return total;
+}
+
+std::string ShardExecutor::stats() const
+{
+    std::string out = "shards=" + std::to_string(shards_.size());
+    for (std::size_t i = 0; i < shards_.size(); ++i) {
+        out += " [s" + std::to_string(i) + " " + shards_[i]->queue.stats() + "]";
+    }
+    return out;
+}
@@ -0,0 +1,61 @@
+﻿#pragma once
+#ifndef SHARD_EXECUTOR_H
+#define SHARD_EXECUTOR_H
+
+#include "ingress_queue.h"
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 按键（群号）分片的执行器：每个分片一个线程、一条独立的入口队列
+// 同一个群的消息总落在同一分片、由同一线程依次执行；不同群分散到各分片并行
+// 因此只属于某个群的状态（猜数、+1 统计等）可以放在 thread_local 中，无需加锁
+// 分片内同一个群严格按到达顺序执行；入口优先级只决定先服务哪个群（积压时有 @指令 的群先于只有闲聊的群）
+class ShardExecutor {
+public:
+    // shards 为 0 时按 CPU 核数；capacity / high_water 为每个分片入口队列的参数
+    ShardExecutor(std::size_t shards, std::size_t capacity, std::size_t high_water);
+    ~ShardExecutor();
+
+    ShardExecutor(const ShardExecutor&) = delete;
+    ShardExecutor& operator=(const ShardExecutor&) = delete;
+
+    std::size_t shard_count() const { return shards_.size(); }
+    std::size_t shard_of(long long key) const;
+
+    // 入队到 key 所在分片（读线程调用），返回 false 表示任务被丢弃或执行器已停止
+    bool post(long long key, IngressPriority prio, std::function<void()> task);
+
+    // 停止接收新任务，等待各分片执行完已入队的任务后退出
+    void stop();
+
+    // 当前线程所在分片编号，非分片线程返回 -1
+    static int current_shard();
+
+    // 各分片入口队列深度之和
+    std::size_t depth() const;
+
+    // 统计摘要：分片数与各分片入口队列统计
+    std::string stats() const;
+
+private:
+    struct Shard {
+        Shard(std::size_t capacity, std::size_t high_water) : queue(capacity, high_water) {}
+        IngressQueue queue;
+        std::mutex mtx;
+        std::condition_variable cv;
+        bool stopping = false;
+        std::thread thread;
+    };
+
+    void run(std::size_t index);
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+#endif // SHARD_EXECUTOR_H
@@ -0,0 +1,80 @@
+﻿#include "status_command.h"
+#include "config.h"
+#include "pipeline_stats.h"
+#include "frame_router.h"
+#include "outbound_scheduler.h"
+#include "msg_handler.h"
+#include <cstdio>
+#include <string_view>
+
+// 发送者是否在 ADMIN_QQS（逗号分隔）中
+static bool is_admin(std::string_view qq)
+{
+    std::string_view list(ADMIN_QQS);
+    while (!list.empty()) {
+        const size_t comma = list.find(',');
+        std::string_view item = list.substr(0, comma);
+        while (!item.empty() && item.front() == ' ') item.remove_prefix(1);
+        while (!item.empty() && item.back() == ' ') item.remove_suffix(1);
+        if (!item.empty() && item == qq) return true;
+        if (comma == std::string_view::npos) break;
+        list.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+static std::string format_uptime(long long sec)
+{
+    char buf[48];
+    std::snprintf(buf, sizeof(buf), "%lldd %02lld:%02lld:%02lld",
+        sec / 86400, sec / 3600 % 24, sec / 60 % 60, sec % 60);
+    return buf;
+}
+
+// 一行：名称 n=次数 p50/p99/max（微秒）
+static void append_histogram(std::string& out, const std::string& name, const Log2Histogram& h)
+{
+    out += "\n" + name + " n=" + std::to_string(h.count()) + " "
+        + std::to_string(h.percentile(0.5)) + "/" + std::to_string(h.percentile(0.99)) + "/"
+        + std::to_string(h.max());
+}
+
+static std::string build_status()
+{
+    char rate[32];
+    std::snprintf(rate, sizeof(rate), "%.2f", pipeline_message_rate(60));
+
+    std::string out = u8"运行状态（已运行 " + format_uptime(pipeline_uptime_sec()) + u8"）";
+    out += u8"\n群消息 " + std::to_string(pipeline_message_total()) + u8" 条，近 60 秒 " + rate + u8" 条/秒";
+    out += u8"\n入口队列 " + std::to_string(frame_router_queue_depth())
+        + u8"，出站队列 " + std::to_string(outbound_scheduler_depth());
+
+    out += u8"\n各阶段耗时 p50/p99/max（微秒）：";
+    for (int i = 0; i < static_cast<int>(PipelineStage::Count); ++i) {
+        const auto stage = static_cast<PipelineStage>(i);
+        append_histogram(out, pipeline_stage_name(stage), pipeline_histogram(stage));
+    }
+
+    // 只列出触发过的指令，避免回复过长
+    std::string rules;
+    for (const CommandRegistry::RuleStat* st : command_registry().rule_stats()) {
+        if (st->latency.count() == 0) continue;
+        append_histogram(rules, st->name.empty() ? u8"（@机器人）" : st->name, st->latency);
+    }
+    if (!rules.empty()) {
+        out += u8"\n指令耗时 p50/p99/max（微秒）：" + rules;
+    }
+    return out;
+}
+
+void register_status_commands(CommandRegistry& registry)
+{
+    Command status{
+        [](const MessageContext&) -> std::string {
+            return build_status();
+        } };
+    status.guard = [](const MessageContext& ctx) {
+        return is_admin(ctx.user_id_str);
+    };
+    registry.add_exact(u8"状态", status);
+}
@@ -0,0 +1,11 @@
+﻿#pragma once
+#ifndef STATUS_COMMAND_H
+#define STATUS_COMMAND_H
+
+#include "command_registry.h"
+
+// 注册管理员指令：@机器人 + “状态” → 回复各阶段耗时分位数、各指令耗时、消息速率与队列深度
+// 仅 ADMIN_QQS 中的 QQ 号可触发；只读取统计，不清零
+void register_status_commands(CommandRegistry& registry);
+
+#endif // STATUS_COMMAND_H
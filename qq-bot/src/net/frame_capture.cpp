@@ -0,0 +1,211 @@
+﻿#include "frame_capture.h"
+#include "utils.h"
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+
+using steady_clock = std::chrono::steady_clock;
+
+namespace {
+
+constexpr char kMagic[4] = { 'Q', 'Q', 'B', 'C' };
+constexpr std::size_t kWriteBuffer = 256 * 1024;
+constexpr std::uint32_t kMaxFrameBytes = 64u * 1024 * 1024; // 读取时的合理性上限，超出视为文件损坏
+
+std::mutex g_mtx; // 读循环写入与统计定时器 / 主线程的 flush、close 互斥
+std::FILE* g_file = nullptr;
+std::atomic<bool> g_enabled{ false };
+steady_clock::time_point g_started;
+std::atomic<unsigned long long> g_frames{ 0 };
+std::atomic<unsigned long long> g_bytes{ 0 };
+
+void put_u32(unsigned char* p, std::uint32_t v) {
+    for (int i = 0; i < 4; ++i) p[i] = static_cast<unsigned char>(v >> (8 * i));
+}
+
+void put_u64(unsigned char* p, std::uint64_t v) {
+    for (int i = 0; i < 8; ++i) p[i] = static_cast<unsigned char>(v >> (8 * i));
+}
+
+std::uint32_t get_u32(const unsigned char* p) {
+    std::uint32_t v = 0;
+    for (int i = 3; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+
+std::uint64_t get_u64(const unsigned char* p) {
+    std::uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+
+// 准备在已有抓包文件末尾追加：校验文件头，截掉末尾不完整的记录，resume_ns 为新记录的起始偏移
+// 文件不存在或为空时 existing 为 false，由调用方写文件头
+bool prepare_append(const std::string& path, bool& existing, std::uint64_t& resume_ns, unsigned long long& frames)
+{
+    existing = false;
+    resume_ns = 0;
+    frames = 0;
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(path, ec);
+    if (ec || size == 0) return true;
+
+    std::uint64_t end = 16; // 最后一条完整记录之后的位置
+    bool truncated = false;
+    {
+        FrameCaptureReader reader;
+        std::string error;
+        if (!reader.open(path, error)) {
+            write_log(LogLevel::Error, "Frame capture: refuse to append to " + path + ": " + error);
+            return false;
+        }
+        CapturedFrame cf;
+        while (reader.next(cf)) {
+            end += 12 + cf.data.size();
+            resume_ns = cf.offset_ns + 1;
+            ++frames;
+        }
+        truncated = reader.truncated();
+    }
+    if (truncated) {
+        std::filesystem::resize_file(path, end, ec);
+        if (ec) {
+            write_log(LogLevel::Error, "Frame capture: cannot drop the incomplete tail of " + path + ": " + ec.message());
+            return false;
+        }
+        write_log(LogLevel::Warn, "Frame capture: dropped an incomplete record at the end of " + path);
+    }
+    existing = true;
+    return true;
+}
+
+} // namespace
+
+bool frame_capture_open(const std::string& path)
+{
+    if (path.empty()) return false;
+    std::lock_guard<std::mutex> lock(g_mtx);
+    if (g_file != nullptr) return true;
+    bool existing = false;
+    std::uint64_t resume_ns = 0;
+    unsigned long long previous_frames = 0;
+    if (!prepare_append(path, existing, resume_ns, previous_frames)) return false;
+    g_file = std::fopen(path.c_str(), "ab");
+    if (g_file == nullptr) {
+        write_log(LogLevel::Error, "Frame capture: cannot open " + path);
+        return false;
+    }
+    std::setvbuf(g_file, nullptr, _IOFBF, kWriteBuffer);
+
+    if (!existing) {
+        const auto unix_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        unsigned char header[16];
+        std::copy(kMagic, kMagic + 4, header);
+        put_u32(header + 4, FRAME_CAPTURE_VERSION);
+        put_u64(header + 8, static_cast<std::uint64_t>(unix_ns));
+        std::fwrite(header, 1, sizeof(header), g_file);
+    }
+
+    // 追加时把起点前移，使本次的偏移接在上一条记录之后
+    g_started = steady_clock::now() - std::chrono::duration_cast<steady_clock::duration>(std::chrono::nanoseconds(resume_ns));
+    g_enabled.store(true, std::memory_order_release);
+    if (existing) {
+        write_log("Frame capture appending to " + path + " after " + std::to_string(previous_frames) + " frames");
+    } else {
+        write_log("Frame capture started: " + path);
+    }
+    return true;
+}
+
+void frame_capture_close()
+{
+    std::lock_guard<std::mutex> lock(g_mtx);
+    g_enabled.store(false, std::memory_order_release);
+    if (g_file == nullptr) return;
+    std::fclose(g_file);
+    g_file = nullptr;
+    write_log("Frame capture closed, " + std::to_string(g_frames.load(std::memory_order_relaxed)) + " frames");
+}
+
+bool frame_capture_enabled()
+{
+    return g_enabled.load(std::memory_order_acquire);
+}
+
+void frame_capture_write(std::string_view frame, steady_clock::time_point read_at)
+{
+    std::lock_guard<std::mutex> lock(g_mtx);
+    if (g_file == nullptr) return;
+    const auto offset = read_at < g_started ? 0 : std::chrono::duration_cast<std::chrono::nanoseconds>(read_at - g_started).count();
+    unsigned char head[12];
+    put_u64(head, static_cast<std::uint64_t>(offset));
+    put_u32(head + 8, static_cast<std::uint32_t>(frame.size()));
+    std::fwrite(head, 1, sizeof(head), g_file);
+    std::fwrite(frame.data(), 1, frame.size(), g_file);
+    g_frames.fetch_add(1, std::memory_order_relaxed);
+    g_bytes.fetch_add(frame.size(), std::memory_order_relaxed);
+}
+
+void frame_capture_flush()
+{
+    std::lock_guard<std::mutex> lock(g_mtx);
+    if (g_file != nullptr) std::fflush(g_file);
+}
+
+std::string frame_capture_stats()
+{
+    return "capture frames=" + std::to_string(g_frames.load(std::memory_order_relaxed))
+        + " bytes=" + std::to_string(g_bytes.load(std::memory_order_relaxed));
+}
+
+FrameCaptureReader::~FrameCaptureReader()
+{
+    if (file_ != nullptr) std::fclose(file_);
+}
+
+bool FrameCaptureReader::open(const std::string& path, std::string& error)
+{
+    file_ = std::fopen(path.c_str(), "rb");
+    if (file_ == nullptr) {
+        error = "cannot open " + path;
+        return false;
+    }
+    unsigned char header[16];
+    if (std::fread(header, 1, sizeof(header), file_) != sizeof(header)
+        || !std::equal(kMagic, kMagic + 4, header)) {
+        error = "not a capture file (bad magic)";
+        return false;
+    }
+    const std::uint32_t version = get_u32(header + 4);
+    if (version != FRAME_CAPTURE_VERSION) {
+        error = "unsupported capture version " + std::to_string(version);
+        return false;
+    }
+    started_unix_ns_ = get_u64(header + 8);
+    return true;
+}
+
+bool FrameCaptureReader::next(CapturedFrame& out)
+{
+    if (file_ == nullptr) return false;
+    unsigned char head[12];
+    const std::size_t got = std::fread(head, 1, sizeof(head), file_);
+    if (got != sizeof(head)) {
+        truncated_ = got != 0;
+        return false;
+    }
+    const std::uint32_t len = get_u32(head + 8);
+    if (len > kMaxFrameBytes) {
+        truncated_ = true;
+        return false;
+    }
+    out.offset_ns = get_u64(head);
+    out.data.resize(len);
+    if (len > 0 && std::fread(&out.data[0], 1, len, file_) != len) {
+        truncated_ = true;
+        return false;
+    }
+    return true;
+}
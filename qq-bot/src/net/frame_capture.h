@@ -0,0 +1,66 @@
+﻿#pragma once
+#ifndef FRAME_CAPTURE_H
+#define FRAME_CAPTURE_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+// 原始帧抓包：读循环收到的每一帧按到达时间追加到二进制抓包文件，供离线回放复现线上流量
+// 文件格式（整数均为小端）：
+//   文件头  "QQBC" | u32 版本(1) | u64 开始抓包时的 Unix 时间（纳秒）
+//   每条记录 u64 距开始抓包的纳秒数 | u32 帧长度 | 帧原始字节（未做任何编码转换）
+// 重启后继续抓同一个文件时接在末尾追加，偏移接着上一条记录往后计（两次运行之间的停机时间不计入）
+constexpr std::uint32_t FRAME_CAPTURE_VERSION = 1;
+
+// 打开抓包文件，成功后读循环开始记录：文件不存在或为空时写入文件头，已有抓包文件则在最后一条完整记录之后追加
+// （上次被强行结束留下的不完整记录先截掉）；path 为空、打开失败或已有文件不是抓包文件时返回 false，不改动该文件
+bool frame_capture_open(const std::string& path);
+
+// 写出缓冲并关闭文件
+void frame_capture_close();
+
+// 是否正在抓包（读循环据此跳过记录，未开启时只是一次原子读）
+bool frame_capture_enabled();
+
+// 追加一帧（读循环调用）：写入 stdio 缓冲，不逐帧落盘
+void frame_capture_write(std::string_view frame, std::chrono::steady_clock::time_point read_at);
+
+// 把缓冲写入文件（统计定时器与会话结束时调用）
+void frame_capture_flush();
+
+// 统计摘要：已记录的帧数与字节数
+std::string frame_capture_stats();
+
+// 抓包文件读取（回放工具使用）
+struct CapturedFrame {
+    std::uint64_t offset_ns = 0; // 距开始抓包的纳秒数
+    std::string data;
+};
+
+class FrameCaptureReader {
+public:
+    FrameCaptureReader() = default;
+    ~FrameCaptureReader();
+
+    FrameCaptureReader(const FrameCaptureReader&) = delete;
+    FrameCaptureReader& operator=(const FrameCaptureReader&) = delete;
+
+    // 打开并校验文件头，失败时 error 说明原因
+    bool open(const std::string& path, std::string& error);
+
+    // 读取下一帧（复用 out.data 的容量）；文件结束或记录不完整时返回 false
+    bool next(CapturedFrame& out);
+
+    std::uint64_t started_unix_ns() const { return started_unix_ns_; }
+    bool truncated() const { return truncated_; } // 末尾是否有不完整的记录（抓包进程被强行结束）
+
+private:
+    std::FILE* file_ = nullptr;
+    std::uint64_t started_unix_ns_ = 0;
+    bool truncated_ = false;
+};
+
+#endif // FRAME_CAPTURE_H
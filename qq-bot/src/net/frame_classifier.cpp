@@ -0,0 +1,238 @@
+﻿#include "frame_classifier.h"
+#include "stats.h"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+constexpr std::size_t kClassCount = static_cast<std::size_t>(FrameClass::Count);
+
+const char* const kClassNames[kClassCount] = {
+    "group", "private", "echo", "heartbeat", "lifecycle", "meta", "notice", "request", "unknown"
+};
+
+struct ClassCounters {
+    std::atomic<unsigned long long> frames{ 0 };
+    std::atomic<unsigned long long> bytes{ 0 };
+};
+
+ClassCounters g_classes[kClassCount];
+SampleStat g_classify_ns;
+std::atomic<unsigned long long> g_parsed_bytes{ 0 };
+std::atomic<unsigned long long> g_parse_ns{ 0 };
+
+// 顶层扫描器：p 始终指向下一个未读字节，任何不认识的结构都返回 false（交给完整解析）
+struct Scanner {
+    const char* p;
+    const char* end;
+
+    void skip_ws() {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) ++p;
+    }
+
+    // 读一个字符串（p 指向开头的引号），out 为引号内的原始字节；含转义时 escaped=true
+    bool read_string(std::string_view& out, bool& escaped) {
+        ++p;
+        const char* start = p;
+        escaped = false;
+        for (;;) {
+            const void* q = std::memchr(p, '"', static_cast<std::size_t>(end - p));
+            if (!q) return false;
+            const char* quote = static_cast<const char*>(q);
+            // 引号前连续反斜杠为奇数个时该引号被转义
+            std::size_t backslashes = 0;
+            for (const char* b = quote; b > start && b[-1] == '\\'; --b) ++backslashes;
+            if (backslashes % 2 == 0) {
+                if (!escaped) escaped = std::memchr(start, '\\', static_cast<std::size_t>(quote - start)) != nullptr;
+                out = std::string_view(start, static_cast<std::size_t>(quote - start));
+                p = quote + 1;
+                return true;
+            }
+            escaped = true;
+            p = quote + 1;
+        }
+    }
+
+    bool skip_string() {
+        std::string_view ignored;
+        bool escaped;
+        return read_string(ignored, escaped);
+    }
+
+    // 跳过任意值：嵌套的对象 / 数组只数括号，字符串整体跳过
+    bool skip_value() {
+        if (p >= end) return false;
+        if (*p == '"') return skip_string();
+        if (*p == '{' || *p == '[') {
+            int depth = 0;
+            while (p < end) {
+                const char c = *p;
+                if (c == '"') {
+                    if (!skip_string()) return false;
+                    continue;
+                }
+                if (c == '/') return false; // 注释交给完整解析
+                if (c == '{' || c == '[') ++depth;
+                else if (c == '}' || c == ']') {
+                    if (--depth == 0) { ++p; return true; }
+                }
+                ++p;
+            }
+            return false;
+        }
+        // 数字 / true / false / null
+        const char* start = p;
+        while (p < end && *p != ',' && *p != '}' && *p != ']' && *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r') {
+            if (*p == '/') return false;
+            ++p;
+        }
+        return p > start;
+    }
+
+    // 读整数值（心跳 interval），非整数时只跳过
+    bool read_integer(long long& out) {
+        const char* start = p;
+        if (!skip_value()) return false;
+        const char* q = start;
+        bool negative = false;
+        if (q < p && *q == '-') { negative = true; ++q; }
+        if (q == p) return true;
+        long long v = 0;
+        for (; q < p; ++q) {
+            if (*q < '0' || *q > '9') return true;
+            v = v * 10 + (*q - '0');
+        }
+        out = negative ? -v : v;
+        return true;
+    }
+};
+
+struct TopLevelFields {
+    std::string_view post_type;
+    std::string_view message_type;
+    std::string_view meta_event_type;
+    long long interval = 0;
+    bool has_echo = false;
+};
+
+bool scan_top_level(std::string_view frame, TopLevelFields& f) {
+    Scanner s{ frame.data(), frame.data() + frame.size() };
+    s.skip_ws();
+    if (s.p >= s.end || *s.p != '{') return false;
+    ++s.p;
+    for (;;) {
+        s.skip_ws();
+        if (s.p >= s.end) return false;
+        if (*s.p == '}') return true;
+        if (*s.p != '"') return false;
+        std::string_view key;
+        bool escaped;
+        if (!s.read_string(key, escaped)) return false;
+        s.skip_ws();
+        if (s.p >= s.end || *s.p != ':') return false;
+        ++s.p;
+        s.skip_ws();
+        if (s.p >= s.end) return false;
+
+        std::string_view* target = nullptr;
+        if (key == "post_type") target = &f.post_type;
+        else if (key == "message_type") target = &f.message_type;
+        else if (key == "meta_event_type") target = &f.meta_event_type;
+
+        if (target && *s.p == '"') {
+            // 类型取值不会含转义；若含则无法直接比较，放弃预分类
+            if (!s.read_string(*target, escaped) || escaped) return false;
+        } else if (key == "interval") {
+            if (!s.read_integer(f.interval)) return false;
+        } else {
+            if (key == "echo") f.has_echo = true;
+            if (!s.skip_value()) return false;
+        }
+
+        s.skip_ws();
+        if (s.p >= s.end) return false;
+        if (*s.p == ',') { ++s.p; continue; }
+        if (*s.p == '}') return true;
+        return false;
+    }
+}
+
+std::string micros_text(double ns) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.0fus", ns / 1000.0);
+    return buf;
+}
+
+} // namespace
+
+bool frame_class_needs_parse(FrameClass cls)
+{
+    return cls == FrameClass::GroupMessage || cls == FrameClass::ApiResponse || cls == FrameClass::Unknown;
+}
+
+FrameClassification classify_frame(std::string_view frame)
+{
+    FrameClassification result;
+    TopLevelFields f;
+    if (!scan_top_level(frame, f)) return result;
+
+    if (f.has_echo) {
+        result.cls = FrameClass::ApiResponse;
+    } else if (f.post_type == "message") {
+        if (f.message_type == "group") result.cls = FrameClass::GroupMessage;
+        else if (f.message_type == "private") result.cls = FrameClass::PrivateMessage;
+    } else if (f.post_type == "meta_event") {
+        if (f.meta_event_type == "heartbeat") {
+            result.cls = FrameClass::Heartbeat;
+            result.heartbeat_interval_ms = f.interval;
+        } else if (f.meta_event_type == "lifecycle") {
+            result.cls = FrameClass::Lifecycle;
+        } else {
+            result.cls = FrameClass::OtherMeta;
+        }
+    } else if (f.post_type == "notice") {
+        result.cls = FrameClass::Notice;
+    } else if (f.post_type == "request") {
+        result.cls = FrameClass::Request;
+    }
+    return result;
+}
+
+void frame_classifier_record(FrameClass cls, std::size_t bytes, long long classify_ns)
+{
+    ClassCounters& c = g_classes[static_cast<std::size_t>(cls)];
+    c.frames.fetch_add(1, std::memory_order_relaxed);
+    c.bytes.fetch_add(bytes, std::memory_order_relaxed);
+    g_classify_ns.add(classify_ns);
+}
+
+void frame_classifier_record_parse(std::size_t bytes, long long parse_ns)
+{
+    g_parsed_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    g_parse_ns.fetch_add(parse_ns < 0 ? 0 : static_cast<unsigned long long>(parse_ns), std::memory_order_relaxed);
+}
+
+std::string frame_classifier_stats()
+{
+    const unsigned long long parsed_bytes = g_parsed_bytes.load(std::memory_order_relaxed);
+    const double ns_per_byte = parsed_bytes == 0 ? 0.0
+        : static_cast<double>(g_parse_ns.load(std::memory_order_relaxed)) / static_cast<double>(parsed_bytes);
+
+    std::string out = "frame classes";
+    double avoided_ns = 0.0;
+    for (std::size_t i = 0; i < kClassCount; ++i) {
+        const unsigned long long n = g_classes[i].frames.load(std::memory_order_relaxed);
+        if (n == 0) continue;
+        out += std::string(" ") + kClassNames[i] + "=" + std::to_string(n);
+        if (!frame_class_needs_parse(static_cast<FrameClass>(i))) {
+            const double ns = ns_per_byte * static_cast<double>(g_classes[i].bytes.load(std::memory_order_relaxed));
+            avoided_ns += ns;
+            out += "(~" + micros_text(ns) + ")";
+        }
+    }
+    char rate[32];
+    std::snprintf(rate, sizeof(rate), "%.1f", ns_per_byte);
+    return out + ", parse " + rate + "ns/B, parse avoided ~" + micros_text(avoided_ns)
+        + ", classify " + g_classify_ns.summary("ns");
+}
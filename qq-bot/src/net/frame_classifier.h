@@ -0,0 +1,36 @@
+﻿#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// 帧预分类：在 DOM 解析之前按字节扫描顶层的 post_type / message_type / meta_event_type / echo，
+// 只有需要业务处理的帧（群消息、API 回执、无法判定的帧）才进入 json::parse
+enum class FrameClass {
+    GroupMessage,
+    PrivateMessage,
+    ApiResponse,
+    Heartbeat,
+    Lifecycle,
+    OtherMeta,
+    Notice,
+    Request,
+    Unknown,    // 扫描失败或类型无法判定，交给完整解析
+    Count
+};
+
+struct FrameClassification {
+    FrameClass cls = FrameClass::Unknown;
+    long long heartbeat_interval_ms = 0; // 仅 Heartbeat 有效
+};
+
+// 该类帧是否需要完整解析（群消息 / API 回执 / 未知）
+bool frame_class_needs_parse(FrameClass cls);
+
+// 字节级分类：只看顶层键，跳过字符串与嵌套对象；不分配内存、不校验编码
+FrameClassification classify_frame(std::string_view frame);
+
+// 统计：每类帧的数量与字节数、分类耗时；完整解析的耗时用于估算 ns/字节，
+// 再乘以被跳过的字节数，得到各类帧省下的解析时间
+void frame_classifier_record(FrameClass cls, std::size_t bytes, long long classify_ns);
+void frame_classifier_record_parse(std::size_t bytes, long long parse_ns);
+std::string frame_classifier_stats();
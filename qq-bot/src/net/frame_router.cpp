@@ -0,0 +1,204 @@
+﻿#include "frame_router.h"
+#include "frame_classifier.h"
+#include "utils.h"
+#include "utf8.h"
+#include "msg_handler.h"
+#include "group_message_event.h"
+#include "message_context.h"
+#include "shard_executor.h"
+#include "guess_number.h"
+#include "config.h"
+#include "onebot_rpc.h"
+#include "pipeline_stats.h"
+#include <memory>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+using nlohmann::json;
+
+static std::unique_ptr<ShardExecutor> g_executor;
+
+// 十六进制预览
+static std::string hex_preview(std::string_view s, size_t max_len = 32) {
+    std::ostringstream oss;
+    oss << std::hex << std::uppercase;
+    size_t limit = std::min(s.size(), max_len);
+    for (size_t i = 0; i < limit; ++i) {
+        oss << std::setw(2) << std::setfill('0') << (static_cast<unsigned int>(static_cast<unsigned char>(s[i])));
+        if (i + 1 != limit) oss << ' ';
+    }
+    if (s.size() > limit) oss << " ...";
+    return oss.str();
+}
+
+// 确定帧的 UTF-8 文本：先校验 UTF-8，合法则直接返回读缓冲区上的视图，否则按 GBK->UTF-8 转换
+// 编码判定不再依赖捕获 json::exception（316/101）；转换结果在本线程下一次调用前有效
+static std::string_view frame_text(std::string_view frame, std::string& parse_path) {
+    if (utf8_is_valid(frame)) {
+        parse_path = "raw-utf8";
+        return frame;
+    }
+    write_log("Frame is not valid UTF-8, hex: " + hex_preview(frame));
+    // 转换缓冲按线程复用
+    static thread_local std::string converted;
+    const size_t replaced = gbk_to_utf8(frame.data(), frame.size(), converted);
+    parse_path = "gbk->utf8";
+    write_log("Fallback GBK->UTF8 done (" + std::to_string(replaced) + " invalid chars replaced), first bytes(hex): "
+        + hex_preview(converted));
+    return converted;
+}
+
+// DOM 解析（API 回执与预分类无法判定的帧）
+static bool parse_dom(std::string_view text, const std::string& parse_path, json& msg_data) {
+    try {
+        msg_data = json::parse(text.data(), text.data() + text.size(), nullptr, true, true);
+        return true;
+    } catch (const json::exception& e) {
+        write_log("Parse " + parse_path + " failed(id=" + std::to_string(e.id) + "): " + std::string(e.what()));
+    }
+    return false;
+}
+
+static long long micros_since(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t).count();
+}
+
+static long long nanos_between(std::chrono::steady_clock::time_point a, std::chrono::steady_clock::time_point b) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count();
+}
+
+// 按 key 入队到对应分片：群消息以群号为 key，同群消息在同一线程上依次执行
+static bool enqueue(long long key, IngressPriority prio, std::function<void()> task) {
+    return g_executor && g_executor->post(key, prio, std::move(task));
+}
+
+IngressPriority group_message_priority(const GroupMessageEvent& ev) {
+    if (is_at_bot(ev)) return IngressPriority::Command;
+    // 无需 @ 的指令（绑定群聊、设置学期 等）按指令表的精确 / 前缀匹配认出，积压时不随闲聊丢弃
+    thread_local std::string text; // 读线程上调用，缓冲跨消息复用
+    unaddressed_command_text(ev, text);
+    if (command_registry().matches_text(text)) return IngressPriority::Command;
+    if (looks_like_guess_input(ev.raw_message)) return IngressPriority::Game;
+    return IngressPriority::Passive;
+}
+
+static void dispatch_group_message(GroupMessageEvent ev, const std::string& parse_path,
+    std::chrono::steady_clock::time_point read_at) {
+    const IngressPriority prio = group_message_priority(ev);
+    const long long group_id = ev.group_id;
+    enqueue(group_id, prio, [ev = std::move(ev), parse_path, read_at]() {
+        pipeline_record(PipelineStage::Queue, micros_since(read_at));
+        if (log_enabled(LogLevel::Debug)) {
+            write_log(LogLevel::Debug, "Event decoded via " + parse_path + ", read->dispatch " + std::to_string(micros_since(read_at)) + "us");
+        }
+        handle_group_message(ev);
+        pipeline_record(PipelineStage::Handle, micros_since(read_at));
+    });
+}
+
+void frame_router_start(int shards)
+{
+    g_executor.reset(new ShardExecutor(static_cast<std::size_t>(std::max(0, shards)),
+        static_cast<std::size_t>(INGRESS_QUEUE_CAPACITY), static_cast<std::size_t>(INGRESS_HIGH_WATER)));
+    write_log("Frame router started, shards: " + std::to_string(g_executor->shard_count()));
+}
+
+void frame_router_stop()
+{
+    if (!g_executor) return;
+    g_executor->stop();
+    g_executor.reset();
+}
+
+std::size_t frame_router_queue_depth()
+{
+    return g_executor ? g_executor->depth() : 0;
+}
+
+std::string frame_router_stats()
+{
+    return g_executor ? g_executor->stats() : std::string("shards=0");
+}
+
+FrameInfo frame_router_on_frame(std::string_view frame, std::chrono::steady_clock::time_point read_at)
+{
+    FrameInfo info;
+
+    // 先按字节预分类：心跳、生命周期、私聊等直接在此结束，不做 DOM 解析
+    const auto classify_start = std::chrono::steady_clock::now();
+    const FrameClassification cls = classify_frame(frame);
+    const auto classify_end = std::chrono::steady_clock::now();
+    frame_classifier_record(cls.cls, frame.size(), nanos_between(classify_start, classify_end));
+    if (cls.cls == FrameClass::Heartbeat) {
+        info.kind = FrameKind::Heartbeat;
+        info.heartbeat_interval_ms = cls.heartbeat_interval_ms;
+        return info;
+    }
+    if (!frame_class_needs_parse(cls.cls)) {
+        return info;
+    }
+
+    std::string parse_path;
+    const std::string_view text = frame_text(frame, parse_path);
+
+    // 群消息：SAX 直接解码为事件结构，不构建 DOM
+    if (cls.cls == FrameClass::GroupMessage) {
+        GroupMessageEvent ev;
+        const bool decoded = decode_group_message_event(text, ev);
+        const auto parsed_at = std::chrono::steady_clock::now();
+        frame_classifier_record_parse(frame.size(), nanos_between(classify_end, parsed_at));
+        pipeline_record(PipelineStage::Parse, nanos_between(classify_start, parsed_at) / 1000);
+        if (!decoded) {
+            write_log("Drop frame (unparsed). Preview: " + std::string(frame.substr(0, 120)));
+            info.kind = FrameKind::Unparsed;
+            return info;
+        }
+        dispatch_group_message(std::move(ev), parse_path, read_at);
+        info.kind = FrameKind::GroupMessage;
+        return info;
+    }
+
+    json msg_data;
+    const bool decoded = parse_dom(text, parse_path, msg_data);
+    frame_classifier_record_parse(frame.size(), nanos_between(classify_end, std::chrono::steady_clock::now()));
+    if (!decoded) {
+        write_log("Drop frame (unparsed). Preview: " + std::string(frame.substr(0, 120)));
+        info.kind = FrameKind::Unparsed;
+        return info;
+    }
+    if (!g_executor) return info;
+
+    // 优先处理带 echo 的 API 回执（不属于任何群，按 echo 分散到各分片）
+    if (msg_data.contains("echo")) {
+        const long long echo = msg_data["echo"].is_number_integer() ? msg_data["echo"].get<long long>() : 0;
+        enqueue(echo, IngressPriority::Command, [msg_data = std::move(msg_data)]() {
+            onebot_rpc_on_response(msg_data); // 按 echo 完成待决请求
+        });
+        info.kind = FrameKind::ApiResponse;
+        return info;
+    }
+
+    // 心跳：只交给看门狗，不进入线程池（预分类无法判定时才会走到这里）
+    if (msg_data.contains("post_type") && msg_data["post_type"] == "meta_event"
+        && msg_data.contains("meta_event_type") && msg_data["meta_event_type"] == "heartbeat") {
+        info.kind = FrameKind::Heartbeat;
+        if (msg_data.contains("interval") && msg_data["interval"].is_number_integer()) {
+            info.heartbeat_interval_ms = msg_data["interval"].get<long long>();
+        }
+        return info;
+    }
+
+    // 预分类未认出的群消息（罕见）：按同一文本再走一次 SAX 解码
+    if (msg_data.contains("post_type") && msg_data["post_type"] == "message"
+        && msg_data.contains("message_type") && msg_data["message_type"] == "group") {
+        GroupMessageEvent ev;
+        if (decode_group_message_event(text, ev)) {
+            dispatch_group_message(std::move(ev), parse_path, read_at);
+            info.kind = FrameKind::GroupMessage;
+        }
+    } else {
+        write_log("Ignore non-group frame");
+    }
+    return info;
+}
@@ -0,0 +1,42 @@
+﻿#pragma once
+#include "group_message_event.h"
+#include "ingress_queue.h"
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// 帧类型（供读循环更新心跳看门狗等连接状态）
+enum class FrameKind {
+    GroupMessage,
+    ApiResponse,
+    Heartbeat,
+    Other,
+    Unparsed
+};
+
+struct FrameInfo {
+    FrameKind kind = FrameKind::Other;
+    long long heartbeat_interval_ms = 0; // 仅 Heartbeat 有效，OneBot 心跳携带的 interval
+};
+
+// 启动按群分片的消息执行器（shards 为 0 时按 CPU 核数）
+void frame_router_start(int shards);
+
+// 停止执行器，等待已派发的任务执行完毕
+void frame_router_stop();
+
+// 各分片入口队列中尚未执行的任务总数
+std::size_t frame_router_queue_depth();
+
+// 各分片入口队列统计摘要（各优先级入队 / 丢弃数、深度、排队等待）
+std::string frame_router_stats();
+
+// 群消息的入口优先级：@机器人 或命中精确 / 前缀指令（无论是否要求 @）为 Command，猜数输入为 Game，其余为 Passive
+// 依赖已构建的指令表（init_command_registry 须先于首帧完成）
+IngressPriority group_message_priority(const GroupMessageEvent& ev);
+
+// 解码一帧并派发到所属分片（由读循环调用，本身不执行任何业务逻辑）
+// frame 直接指向读缓冲区，仅在本次调用期间有效；解码后的结果自行持有数据
+// read_at：该帧读取完成的时间点，用于统计 读取->派发 延迟
+FrameInfo frame_router_on_frame(std::string_view frame, std::chrono::steady_clock::time_point read_at);
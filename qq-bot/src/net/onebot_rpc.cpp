@@ -0,0 +1,227 @@
+﻿#include "onebot_rpc.h"
+#include "config.h"
+#include "utils.h"
+#include "stats.h"
+#include "ws_send_queue.h"
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+using steady_clock = std::chrono::steady_clock;
+using nlohmann::json;
+
+namespace {
+
+struct PendingRequest {
+    std::string action;
+    RpcCallback cb;
+    steady_clock::time_point sent_at;
+    steady_clock::time_point deadline;
+};
+
+struct ActionStats {
+    LatencyStat rtt;
+    std::atomic<unsigned long long> failed{ 0 };
+    std::atomic<unsigned long long> timeouts{ 0 };
+};
+
+std::mutex g_mtx;
+std::unordered_map<long long, PendingRequest> g_pending;
+std::map<std::string, std::unique_ptr<ActionStats>> g_stats; // 受 g_mtx 保护（仅增不删）
+std::atomic<long long> g_next_echo{ 1 };
+std::atomic<unsigned long long> g_unknown_echo{ 0 };
+
+std::chrono::milliseconds default_timeout(const std::string& action) {
+    if (action == "get_group_member_list") return std::chrono::milliseconds(RPC_MEMBER_LIST_TIMEOUT_MS);
+    return std::chrono::milliseconds(RPC_DEFAULT_TIMEOUT_MS);
+}
+
+ActionStats& stats_for(const std::string& action) {
+    auto& slot = g_stats[action];
+    if (!slot) slot.reset(new ActionStats());
+    return *slot;
+}
+
+// 在锁外完成一个请求
+void complete(PendingRequest& req, RpcResult result) {
+    if (!result.ok) {
+        write_log(LogLevel::Warn, "API " + req.action + " failed: " + result.error + " (retcode=" + std::to_string(result.retcode) + ")");
+    }
+    if (!req.cb) return;
+    try {
+        req.cb(std::move(result));
+    } catch (const std::exception& e) {
+        write_log(LogLevel::Error, "API " + req.action + " callback threw: " + std::string(e.what()));
+    } catch (...) {
+        write_log(LogLevel::Error, "API " + req.action + " callback threw: unknown exception");
+    }
+}
+
+RpcResult failure(const std::string& error) {
+    RpcResult r;
+    r.error = error;
+    return r;
+}
+
+// 登记待决请求并写出已带 echo 的帧
+void send_registered(const std::string& action, long long echo, std::string frame, RpcCallback cb,
+    std::chrono::milliseconds timeout)
+{
+    const auto now = steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(g_mtx);
+        stats_for(action);
+        g_pending.emplace(echo, PendingRequest{ action, std::move(cb), now,
+            now + (timeout.count() > 0 ? timeout : default_timeout(action)) });
+    }
+    if (ws_send(std::move(frame))) return;
+
+    // 未连接：立即失败
+    PendingRequest req;
+    {
+        std::lock_guard<std::mutex> lock(g_mtx);
+        auto it = g_pending.find(echo);
+        if (it == g_pending.end()) return;
+        req = std::move(it->second);
+        g_pending.erase(it);
+        stats_for(action).failed.fetch_add(1, std::memory_order_relaxed);
+    }
+    complete(req, failure("not connected"));
+}
+
+} // namespace
+
+void onebot_rpc_call(json request, RpcCallback cb, std::chrono::milliseconds timeout)
+{
+    const std::string action = request.value("action", std::string());
+    const long long echo = g_next_echo.fetch_add(1, std::memory_order_relaxed);
+    request["echo"] = echo;
+    send_registered(action, echo, request.dump(), std::move(cb), timeout);
+}
+
+void onebot_rpc_call_frame(const std::string& action, std::string frame, RpcCallback cb, std::chrono::milliseconds timeout)
+{
+    const long long echo = g_next_echo.fetch_add(1, std::memory_order_relaxed);
+    if (!frame.empty() && frame.back() == '}') frame.pop_back();
+    frame.append(",\"echo\":").append(std::to_string(echo)).push_back('}');
+    send_registered(action, echo, std::move(frame), std::move(cb), timeout);
+}
+
+std::future<RpcResult> onebot_rpc_call_future(json request, std::chrono::milliseconds timeout)
+{
+    auto promise = std::make_shared<std::promise<RpcResult>>();
+    std::future<RpcResult> future = promise->get_future();
+    onebot_rpc_call(std::move(request), [promise](RpcResult r) { promise->set_value(std::move(r)); }, timeout);
+    return future;
+}
+
+void onebot_rpc_on_response(const json& frame)
+{
+    auto echo_it = frame.find("echo");
+    if (echo_it == frame.end() || !echo_it->is_number_integer()) {
+        g_unknown_echo.fetch_add(1, std::memory_order_relaxed);
+        write_log("API response with unrecognized echo: " + (echo_it == frame.end() ? std::string("<none>") : echo_it->dump()));
+        return;
+    }
+    const long long echo = echo_it->get<long long>();
+
+    PendingRequest req;
+    {
+        std::lock_guard<std::mutex> lock(g_mtx);
+        auto it = g_pending.find(echo);
+        if (it == g_pending.end()) {
+            g_unknown_echo.fetch_add(1, std::memory_order_relaxed);
+            write_log("API response for unknown or expired echo " + std::to_string(echo));
+            return;
+        }
+        req = std::move(it->second);
+        g_pending.erase(it);
+    }
+
+    // 逐字段检查类型后读取（NapCat 可能给出 "message": null、字符串形式的 retcode 等），
+    // 任何形态的回执都不抛异常，保证待决请求一定完成
+    RpcResult result;
+    auto retcode_it = frame.find("retcode");
+    if (retcode_it == frame.end()) {
+        result.retcode = 0;
+    } else if (retcode_it->is_number_integer()) {
+        result.retcode = retcode_it->get<long long>();
+    } else if (retcode_it->is_string()) {
+        try {
+            result.retcode = std::stoll(retcode_it->get_ref<const std::string&>());
+        } catch (...) {
+            result.retcode = -1;
+        }
+    } else {
+        result.retcode = -1;
+    }
+    auto string_field = [&frame](const char* key) -> std::string {
+        auto it = frame.find(key);
+        return it != frame.end() && it->is_string() ? it->get<std::string>() : std::string();
+    };
+    const auto status_it = frame.find("status");
+    const std::string status = status_it == frame.end() ? std::string("ok") : string_field("status");
+    result.ok = status == "ok" && result.retcode == 0;
+    if (!result.ok) {
+        result.error = string_field("wording");
+        if (result.error.empty()) result.error = string_field("message");
+        if (result.error.empty()) result.error = status.empty() || status == "ok" ? "retcode " + std::to_string(result.retcode) : status;
+    }
+    auto data_it = frame.find("data");
+    if (data_it != frame.end()) result.data = *data_it;
+
+    ActionStats* st = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(g_mtx);
+        st = &stats_for(req.action);
+    }
+    st->rtt.add(std::chrono::duration_cast<std::chrono::microseconds>(steady_clock::now() - req.sent_at).count());
+    if (!result.ok) st->failed.fetch_add(1, std::memory_order_relaxed);
+    complete(req, std::move(result));
+}
+
+void onebot_rpc_sweep()
+{
+    const auto now = steady_clock::now();
+    std::vector<PendingRequest> expired;
+    {
+        std::lock_guard<std::mutex> lock(g_mtx);
+        for (auto it = g_pending.begin(); it != g_pending.end();) {
+            if (it->second.deadline <= now) {
+                stats_for(it->second.action).timeouts.fetch_add(1, std::memory_order_relaxed);
+                expired.push_back(std::move(it->second));
+                it = g_pending.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    for (auto& req : expired) complete(req, failure("timeout"));
+}
+
+void onebot_rpc_fail_all(const std::string& reason)
+{
+    std::unordered_map<long long, PendingRequest> failed;
+    {
+        std::lock_guard<std::mutex> lock(g_mtx);
+        failed.swap(g_pending);
+        for (auto& kv : failed) stats_for(kv.second.action).failed.fetch_add(1, std::memory_order_relaxed);
+    }
+    for (auto& kv : failed) complete(kv.second, failure(reason));
+}
+
+std::string onebot_rpc_stats()
+{
+    std::lock_guard<std::mutex> lock(g_mtx);
+    std::string out = "rpc pending=" + std::to_string(g_pending.size())
+        + " unknown_echo=" + std::to_string(g_unknown_echo.load(std::memory_order_relaxed));
+    for (const auto& kv : g_stats) {
+        out += ", " + kv.first + " rtt " + kv.second->rtt.summary()
+            + " failed=" + std::to_string(kv.second->failed.load(std::memory_order_relaxed))
+            + " timeouts=" + std::to_string(kv.second->timeouts.load(std::memory_order_relaxed));
+    }
+    return out;
+}
@@ -0,0 +1,44 @@
+﻿#pragma once
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <string>
+
+// OneBot 请求/响应层：每个请求分配整数 echo 并登记到待决表，收到同 echo 的回执或超时后完成
+struct RpcResult {
+    bool ok = false;            // status == "ok" 且 retcode == 0
+    long long retcode = -1;     // 超时 / 断线 / 发送失败时为 -1
+    std::string error;          // 失败原因：timeout / disconnected / not connected / 服务端 wording
+    nlohmann::json data;        // 回执中的 data 字段
+};
+
+using RpcCallback = std::function<void(RpcResult)>;
+
+// 发起请求：request 形如 {"action": ..., "params": {...}}，由本层写入 echo 后经发送队列写出
+// cb 在完成的线程上执行（回执：按 echo 选中的任意分片线程；超时 / 断线：io 线程），应尽量简短；为空时失败只记日志
+// 因此 cb 不能依赖分片的 thread_local 状态（猜数、+1 等），读写共享状态须自行加锁（如 member_cache 由其互斥量保护）
+// timeout 为 0 时使用该 action 的默认期限（见 config.h）
+void onebot_rpc_call(nlohmann::json request, RpcCallback cb = nullptr,
+    std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
+
+// 发送已序列化好的请求帧（如 ReplyFrame）：frame 为不含 echo 的 JSON 对象，
+// 本层在末尾的 '}' 前补上 ,"echo":N 后直接写出，不再解析或重新序列化
+void onebot_rpc_call_frame(const std::string& action, std::string frame, RpcCallback cb = nullptr,
+    std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
+
+// 同上，以 future 返回结果（不要在 io 线程或处理回执的业务线程上等待）
+std::future<RpcResult> onebot_rpc_call_future(nlohmann::json request,
+    std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
+
+// 收到带 echo 的回执（由帧路由在业务线程调用）
+void onebot_rpc_on_response(const nlohmann::json& frame);
+
+// 清扫已过期的请求（io 线程定时调用）
+void onebot_rpc_sweep();
+
+// 连接断开：以 disconnected 失败全部待决请求
+void onebot_rpc_fail_all(const std::string& reason);
+
+// 统计摘要：待决数、超时 / 失败数、各 action 往返延迟
+std::string onebot_rpc_stats();
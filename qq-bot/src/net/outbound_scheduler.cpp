@@ -0,0 +1,283 @@
+﻿#include "outbound_scheduler.h"
+#include "config.h"
+#include "utils.h"
+#include "stats.h"
+#include "pipeline_stats.h"
+#include "onebot_rpc.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+using steady_clock = std::chrono::steady_clock;
+
+namespace {
+
+// 令牌桶：按 rate 个/秒持续补充，最多积攒 burst 个
+struct TokenBucket {
+    double rate;
+    double burst;
+    double tokens;
+    steady_clock::time_point last;
+
+    TokenBucket(double rate_per_sec, double burst_size)
+        : rate(rate_per_sec), burst(burst_size), tokens(burst_size), last(steady_clock::now()) {}
+
+    void refill(steady_clock::time_point now) {
+        if (now <= last) return;
+        tokens = std::min(burst, tokens + std::chrono::duration<double>(now - last).count() * rate);
+        last = now;
+    }
+
+    bool ready() const { return tokens >= 1.0; }
+
+    // 距下一个令牌可用的时长（已 refill 之后调用）
+    steady_clock::duration wait_time() const {
+        if (ready()) return steady_clock::duration::zero();
+        return std::chrono::duration_cast<steady_clock::duration>(
+            std::chrono::duration<double>((1.0 - tokens) / rate));
+    }
+};
+
+struct QueuedMessage {
+    ReplyFrame frame;
+    steady_clock::time_point not_before; // 批量消息的预定发出时间；交互消息为提交时间
+};
+
+// 群的发送统计：与 GroupQueue 分开保存，群空闲被移除后仍保留（机器人所在的群数有限）
+struct GroupSendStats {
+    std::unique_ptr<LatencyStat> lag{ new LatencyStat() }; // 统计读取时不持锁，地址须稳定
+    unsigned long long sent = 0;
+};
+
+struct GroupQueue {
+    TokenBucket bucket{ OUTBOUND_GROUP_RATE_PER_SEC, OUTBOUND_GROUP_BURST };
+    std::deque<QueuedMessage> interactive;
+    std::deque<QueuedMessage> bulk; // 按 not_before 递增
+    GroupSendStats* stats = nullptr; // 指向 g_group_stats 中的同群条目（map 节点地址稳定）
+};
+
+std::mutex g_mtx;
+std::condition_variable g_cv;
+std::map<std::string, GroupQueue> g_groups;
+std::map<std::string, GroupSendStats> g_group_stats; // 不随 g_groups 移除
+TokenBucket g_global{ OUTBOUND_GLOBAL_RATE_PER_SEC, OUTBOUND_GLOBAL_BURST };
+std::size_t g_interactive_depth = 0;
+std::size_t g_bulk_depth = 0;
+steady_clock::time_point g_bulk_tail; // 已排批量消息之后的下一个空位，新批次从这里开始
+bool g_running = false;
+bool g_stop = false;
+std::thread g_thread;
+
+steady_clock::duration seconds_per(double rate) {
+    return std::chrono::duration_cast<steady_clock::duration>(std::chrono::duration<double>(1.0 / rate));
+}
+
+// 取群的排队状态，不存在时新建并关联该群的发送统计；调用方需持有 g_mtx
+GroupQueue& group_queue(const std::string& group_id)
+{
+    GroupQueue& gq = g_groups[group_id];
+    if (gq.stats == nullptr) gq.stats = &g_group_stats[group_id];
+    return gq;
+}
+
+// 移除两个 lane 都已清空、令牌也已攒满的群（与新建的群状态相同，移除后不会多放出突发）
+// 只移除令牌桶与队列，发送统计保留在 g_group_stats
+void prune_idle_groups(steady_clock::time_point now)
+{
+    for (auto it = g_groups.begin(); it != g_groups.end();) {
+        GroupQueue& gq = it->second;
+        if (gq.interactive.empty() && gq.bulk.empty()) {
+            gq.bucket.refill(now);
+            if (gq.bucket.tokens >= gq.bucket.burst) {
+                it = g_groups.erase(it);
+                continue;
+            }
+        }
+        ++it;
+    }
+}
+
+// 在锁内选出下一条可发送的消息：先交互后批量，同一 lane 内取最早提交 / 预定的一条
+// 无可发送消息时返回 nullptr，并把最早可能就绪的时间写入 wake
+std::deque<QueuedMessage>* pick_next(steady_clock::time_point now, GroupQueue*& group, steady_clock::time_point& wake)
+{
+    wake = steady_clock::time_point::max();
+    g_global.refill(now);
+    if (!g_global.ready()) {
+        if (g_interactive_depth + g_bulk_depth > 0) wake = now + g_global.wait_time();
+        return nullptr;
+    }
+
+    std::deque<QueuedMessage>* best = nullptr;
+    for (auto lane_of : { &GroupQueue::interactive, &GroupQueue::bulk }) {
+        for (auto& kv : g_groups) {
+            GroupQueue& gq = kv.second;
+            auto& q = gq.*lane_of;
+            if (q.empty()) continue;
+            gq.bucket.refill(now);
+            const auto ready_at = std::max(q.front().not_before, now + gq.bucket.wait_time());
+            if (ready_at > now) {
+                wake = std::min(wake, ready_at);
+                continue;
+            }
+            if (best == nullptr || q.front().not_before < best->front().not_before) {
+                best = &q;
+                group = &gq;
+            }
+        }
+        if (best != nullptr) return best; // 有可发送的交互消息时不看批量
+    }
+    return nullptr;
+}
+
+void scheduler_loop()
+{
+    std::unique_lock<std::mutex> lock(g_mtx);
+    while (!g_stop) {
+        const auto now = steady_clock::now();
+        GroupQueue* group = nullptr;
+        steady_clock::time_point wake;
+        std::deque<QueuedMessage>* q = pick_next(now, group, wake);
+        if (q == nullptr) {
+            if (wake == steady_clock::time_point::max()) {
+                g_cv.wait(lock);
+            } else {
+                g_cv.wait_until(lock, wake);
+            }
+            continue;
+        }
+
+        QueuedMessage msg = std::move(q->front());
+        q->pop_front();
+        if (q == &group->interactive) --g_interactive_depth; else --g_bulk_depth;
+        g_global.tokens -= 1.0;
+        group->bucket.tokens -= 1.0;
+        ++group->stats->sent;
+        const long long lag_us = std::chrono::duration_cast<std::chrono::microseconds>(now - msg.not_before).count();
+        group->stats->lag->add(lag_us);
+        pipeline_record(PipelineStage::Throttle, lag_us);
+        prune_idle_groups(now);
+
+        lock.unlock();
+        onebot_rpc_call_frame("send_group_msg", msg.frame.release()); // 发送失败 / 超时由 RPC 层记录
+        lock.lock();
+    }
+}
+
+void notify() { g_cv.notify_one(); }
+
+} // namespace
+
+void outbound_scheduler_start()
+{
+    std::lock_guard<std::mutex> lock(g_mtx);
+    if (g_running) return;
+    g_stop = false;
+    g_running = true;
+    g_thread = std::thread(scheduler_loop);
+}
+
+void outbound_scheduler_stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(g_mtx);
+        if (!g_running) return;
+        g_stop = true;
+    }
+    notify();
+    g_thread.join();
+
+    std::lock_guard<std::mutex> lock(g_mtx);
+    const std::size_t dropped = g_interactive_depth + g_bulk_depth;
+    for (auto& kv : g_groups) {
+        kv.second.interactive.clear();
+        kv.second.bulk.clear();
+    }
+    g_interactive_depth = g_bulk_depth = 0;
+    g_running = false;
+    if (dropped > 0) {
+        write_log("Outbound scheduler stopped, dropped " + std::to_string(dropped) + " messages");
+    }
+}
+
+void outbound_send(ReplyFrame frame, SendLane lane)
+{
+    const auto now = steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(g_mtx);
+        GroupQueue& gq = group_queue(std::string(frame.group_id()));
+        if (lane == SendLane::Interactive) {
+            gq.interactive.push_back(QueuedMessage{ std::move(frame), now });
+            ++g_interactive_depth;
+        } else {
+            const auto at = std::max(now, g_bulk_tail);
+            g_bulk_tail = at + (std::max)(seconds_per(OUTBOUND_GLOBAL_RATE_PER_SEC), seconds_per(OUTBOUND_GROUP_RATE_PER_SEC));
+            gq.bulk.push_back(QueuedMessage{ std::move(frame), at });
+            ++g_bulk_depth;
+        }
+    }
+    notify();
+}
+
+void outbound_send_bulk(std::vector<ReplyFrame> batch)
+{
+    if (batch.empty()) return;
+    const auto now = steady_clock::now();
+    const auto size = static_cast<long long>(batch.size());
+
+    // 间隔取 窗口 / 条数，但不小于令牌桶能放行的间隔：全局桶每条 1 / 全局速率；
+    // 同一群占批次的 k / n 时，该群平均每条需 1 / 群速率，折到整批为 k / (n × 群速率)
+    std::map<std::string_view, long long> per_group;
+    long long busiest = 0;
+    for (const auto& m : batch) busiest = (std::max)(busiest, ++per_group[m.group_id()]);
+    const auto window = std::chrono::duration_cast<steady_clock::duration>(std::chrono::milliseconds(OUTBOUND_BULK_SPREAD_MS));
+    const steady_clock::duration step = (std::max)({ steady_clock::duration(window / size),
+        seconds_per(OUTBOUND_GLOBAL_RATE_PER_SEC),
+        steady_clock::duration(seconds_per(OUTBOUND_GROUP_RATE_PER_SEC) * busiest / size) });
+    const long long span_ms = std::chrono::duration_cast<std::chrono::milliseconds>(step * size).count();
+    {
+        std::lock_guard<std::mutex> lock(g_mtx);
+        auto at = std::max(now, g_bulk_tail);
+        for (auto& m : batch) {
+            group_queue(std::string(m.group_id())).bulk.push_back(QueuedMessage{ std::move(m), at });
+            at += step;
+        }
+        g_bulk_tail = at;
+        g_bulk_depth += batch.size();
+    }
+    if (span_ms > OUTBOUND_BULK_SPREAD_MS) {
+        write_log("Outbound bulk batch of " + std::to_string(size) + " messages (" + std::to_string(busiest)
+            + " to one group) cannot fit in " + std::to_string(OUTBOUND_BULK_SPREAD_MS) + "ms at the configured rates, spreading over "
+            + std::to_string(span_ms) + "ms");
+    } else {
+        write_log("Outbound bulk batch queued: " + std::to_string(size) + " messages over "
+            + std::to_string(span_ms) + "ms");
+    }
+    notify();
+}
+
+std::size_t outbound_scheduler_depth()
+{
+    std::lock_guard<std::mutex> lock(g_mtx);
+    return g_interactive_depth + g_bulk_depth;
+}
+
+std::string outbound_scheduler_stats()
+{
+    std::lock_guard<std::mutex> lock(g_mtx);
+    std::string out = "outbound interactive=" + std::to_string(g_interactive_depth)
+        + " bulk=" + std::to_string(g_bulk_depth);
+    for (const auto& kv : g_group_stats) {
+        const auto it = g_groups.find(kv.first);
+        const std::size_t queued = it == g_groups.end() ? 0 : it->second.interactive.size() + it->second.bulk.size();
+        out += ", group " + kv.first + " sent=" + std::to_string(kv.second.sent)
+            + " queued=" + std::to_string(queued)
+            + " lag " + kv.second.lag->summary();
+    }
+    return out;
+}
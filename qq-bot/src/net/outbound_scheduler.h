@@ -0,0 +1,31 @@
+﻿#pragma once
+#include "reply_frame.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// 出站发送调度：每个目标群一个令牌桶，另有一个全局令牌桶，两者都有令牌时才发出
+// 交互回复（Interactive）总是先于批量推送（Bulk）；批量推送按配置窗口均匀摊开，避免触发 QQ 风控
+enum class SendLane {
+    Interactive,
+    Bulk
+};
+
+// 启动调度线程（须在首次发送前调用；之前提交的消息会在启动后发出）
+void outbound_scheduler_start();
+
+// 停止调度线程，尚未发出的消息被丢弃
+void outbound_scheduler_stop();
+
+// 提交一条消息（目标群取自帧内群号），任意线程均可调用，不阻塞
+void outbound_send(ReplyFrame frame, SendLane lane = SendLane::Interactive);
+
+// 提交一批批量消息：排在已有批量消息之后，第 i 条最早在 起点 + i × 间隔 发出
+// 间隔为 OUTBOUND_BULK_SPREAD_MS / 条数，但不小于令牌桶（全局与条数最多的群）允许的间隔；放不进窗口时记日志
+void outbound_send_bulk(std::vector<ReplyFrame> batch);
+
+// 两个 lane 中尚未发出的消息总数
+std::size_t outbound_scheduler_depth();
+
+// 统计摘要：各 lane 排队数，各群发送数与发送滞后（提交 / 预定时间 -> 实际发出）
+std::string outbound_scheduler_stats();
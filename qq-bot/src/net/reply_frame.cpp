@@ -0,0 +1,73 @@
+﻿#include "reply_frame.h"
+#include "utf8.h"
+#include <nlohmann/json.hpp>
+
+namespace {
+
+const char kPrefix[] = "{\"action\":\"send_group_msg\",\"params\":{\"group_id\":\"";
+const char kMiddle[] = "\",\"message\":\"";
+const char kSuffix[] = "\"}}";
+
+// 按 JSON 字符串规则转义追加（不含两侧引号）；非 ASCII 字节原样写入
+void append_escaped(std::string& out, std::string_view s) {
+    static const char hex[] = "0123456789abcdef";
+    std::size_t run = 0; // 尚未写出的连续无需转义字节的起点
+    for (std::size_t i = 0; i < s.size(); ++i) {
+        const unsigned char c = static_cast<unsigned char>(s[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+        out.append(s.data() + run, i - run);
+        run = i + 1;
+        switch (c) {
+        case '"': out.append("\\\""); break;
+        case '\\': out.append("\\\\"); break;
+        case '\n': out.append("\\n"); break;
+        case '\r': out.append("\\r"); break;
+        case '\t': out.append("\\t"); break;
+        case '\b': out.append("\\b"); break;
+        case '\f': out.append("\\f"); break;
+        default:
+            out.append("\\u00");
+            out.push_back(hex[c >> 4]);
+            out.push_back(hex[c & 0xF]);
+            break;
+        }
+    }
+    out.append(s.data() + run, s.size() - run);
+}
+
+// 非法 UTF-8（极少见，如截断的昵称）按 json 库的规则替换为 U+FFFD 后再写入
+void append_string(std::string& out, std::string_view s) {
+    if (utf8_is_valid(s)) {
+        append_escaped(out, s);
+        return;
+    }
+    const std::string quoted = nlohmann::json(std::string(s)).dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+    out.append(quoted, 1, quoted.size() - 2);
+}
+
+} // namespace
+
+void ReplyFrame::assign(std::string_view group_id, std::string_view message)
+{
+    frame_.clear();
+    // 回复中需要转义的只有少量换行 / 引号，按原长加少量余量预留，一般一次分配到位
+    frame_.reserve(sizeof(kPrefix) + sizeof(kMiddle) + sizeof(kSuffix)
+        + group_id.size() + message.size() + message.size() / 16 + 16);
+    frame_.append(kPrefix, sizeof(kPrefix) - 1);
+    group_pos_ = frame_.size();
+    append_string(frame_, group_id);
+    group_len_ = frame_.size() - group_pos_;
+    frame_.append(kMiddle, sizeof(kMiddle) - 1);
+    message_pos_ = frame_.size();
+    append_string(frame_, message);
+    message_len_ = frame_.size() - message_pos_;
+    frame_.append(kSuffix, sizeof(kSuffix) - 1);
+}
+
+std::string ReplyFrame::release()
+{
+    std::string out = std::move(frame_);
+    frame_.clear();
+    group_pos_ = group_len_ = message_pos_ = message_len_ = 0;
+    return out;
+}
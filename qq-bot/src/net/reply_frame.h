@@ -0,0 +1,41 @@
+﻿#pragma once
+#ifndef REPLY_FRAME_H
+#define REPLY_FRAME_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// 预序列化的 send_group_msg 请求帧：不经 json 对象，直接把帧字节写入缓冲
+// {"action":"send_group_msg","params":{"group_id":"<群号>","message":"<转义后的消息>"}}
+// 固定前缀按常量追加，只有群号与消息文本需要转义；echo 由 RPC 层在发送前补到末尾
+// 帧一次分配到位，之后整体移交给出站调度、RPC 与发送队列，途中不再拷贝
+class ReplyFrame {
+public:
+    ReplyFrame() = default;
+    ReplyFrame(std::string_view group_id, std::string_view message) { assign(group_id, message); }
+
+    // 重新生成为发往 group_id 的消息（纯文本或 CQ 码字符串）
+    void assign(std::string_view group_id, std::string_view message);
+
+    bool empty() const { return frame_.empty(); }
+
+    // 完整的帧字节（不含 echo）
+    const std::string& bytes() const { return frame_; }
+
+    // 帧内群号 / 消息文本的视图（消息为 JSON 转义后的形式，换行显示为 \n，便于单行记日志）
+    std::string_view group_id() const { return std::string_view(frame_).substr(group_pos_, group_len_); }
+    std::string_view message() const { return std::string_view(frame_).substr(message_pos_, message_len_); }
+
+    // 取走帧字节交给发送路径，之后本对象为空
+    std::string release();
+
+private:
+    std::string frame_;
+    std::size_t group_pos_ = 0;
+    std::size_t group_len_ = 0;
+    std::size_t message_pos_ = 0;
+    std::size_t message_len_ = 0;
+};
+
+#endif // REPLY_FRAME_H
@@ -0,0 +1,155 @@
+﻿#include "ws_send_queue.h"
+#include "utils.h"
+#include "stats.h"
+#include "pipeline_stats.h"
+#include <boost/asio/post.hpp>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+
+namespace asio = boost::asio;
+namespace beast = boost::beast;
+using steady_clock = std::chrono::steady_clock;
+
+struct PendingFrame {
+    std::string frame;
+    steady_clock::time_point queued_at;
+};
+
+static ws_stream* g_ws = nullptr;
+// 绑定后取代 g_ws；与 g_ws 一样在 g_mtx 下读写，ws_send 在锁内取一份引用、锁外调用
+// （解绑发生在每次重连时，此时出站调度线程可能正在发送）
+static std::shared_ptr<const ws_frame_sink> g_sink;
+
+// 生产者只在锁内向 g_pending 追加；写者一次性把整批换到 g_writing 后无锁逐帧写出
+static std::mutex g_mtx;
+static std::deque<PendingFrame> g_pending;
+static bool g_write_active = false;
+static std::deque<PendingFrame> g_writing; // 仅 io 线程访问
+
+static std::atomic<std::size_t> g_depth{ 0 };
+static std::atomic<std::size_t> g_max_depth{ 0 };
+static std::atomic<unsigned long long> g_failed{ 0 };
+static LatencyStat g_write_latency;
+
+static void write_next();
+
+// 取下一批：队列为空时结束本轮写入（仅此处与入队时加锁）
+static void take_batch()
+{
+    {
+        std::lock_guard<std::mutex> lock(g_mtx);
+        if (g_pending.empty() || g_ws == nullptr) {
+            g_write_active = false;
+            return;
+        }
+        g_writing.swap(g_pending);
+    }
+    write_next();
+}
+
+static void write_next()
+{
+    g_ws->async_write(asio::buffer(g_writing.front().frame),
+        [](beast::error_code ec, std::size_t) {
+            if (g_writing.empty()) return; // 已解绑，队列被清空
+            const auto& done = g_writing.front();
+            const long long us = std::chrono::duration_cast<std::chrono::microseconds>(
+                steady_clock::now() - done.queued_at).count();
+            g_write_latency.add(us);
+            pipeline_record(PipelineStage::Send, us);
+            if (ec) {
+                // 写失败后流已不可用：本批余下的帧不再尝试，一并计为失败；也不再取新批次
+                // （g_write_active 保持为真，之后入队的帧留在 g_pending），关闭底层连接让挂起的读取失败，
+                // 由会话的重连路径调用 ws_send_detach 清理
+                const std::size_t dropped = g_writing.size();
+                g_writing.clear();
+                g_failed.fetch_add(dropped, std::memory_order_relaxed);
+                g_depth.fetch_sub(dropped, std::memory_order_relaxed);
+                write_log("WebSocket send failed: " + ec.message() + ", Error code: " + std::to_string(ec.value())
+                    + ", dropped " + std::to_string(dropped) + " frames, closing connection");
+                beast::error_code ignored;
+                beast::get_lowest_layer(*g_ws).socket().shutdown(asio::ip::tcp::socket::shutdown_both, ignored);
+                beast::get_lowest_layer(*g_ws).close();
+                return;
+            }
+            ws_transport_on_frame_written(done.frame.size());
+            g_writing.pop_front();
+            g_depth.fetch_sub(1, std::memory_order_relaxed);
+
+            if (!g_writing.empty()) {
+                write_next(); // 同一批内背靠背写出，无需再加锁
+            } else {
+                take_batch();
+            }
+        });
+}
+
+void ws_send_attach(ws_stream* ws)
+{
+    std::lock_guard<std::mutex> lock(g_mtx);
+    g_ws = ws;
+}
+
+void ws_send_attach_sink(ws_frame_sink sink)
+{
+    auto bound = sink ? std::make_shared<const ws_frame_sink>(std::move(sink)) : nullptr;
+    std::lock_guard<std::mutex> lock(g_mtx);
+    g_sink = std::move(bound);
+}
+
+void ws_send_detach()
+{
+    std::lock_guard<std::mutex> lock(g_mtx);
+    g_sink.reset();
+    const std::size_t dropped = g_pending.size() + g_writing.size();
+    g_ws = nullptr;
+    g_pending.clear();
+    g_writing.clear();
+    g_write_active = false;
+    g_depth.store(0, std::memory_order_relaxed);
+    if (dropped > 0) {
+        write_log("Send queue detached, dropped " + std::to_string(dropped) + " frames");
+    }
+}
+
+bool ws_send(std::string frame)
+{
+    std::unique_lock<std::mutex> lock(g_mtx);
+    if (g_sink) {
+        // sink 可能同步回调进处理链（回放工具的模拟应答），不能在持锁时调用
+        const std::shared_ptr<const ws_frame_sink> sink = g_sink;
+        lock.unlock();
+        const std::size_t bytes = frame.size();
+        (*sink)(std::move(frame));
+        ws_transport_on_frame_written(bytes);
+        return true;
+    }
+
+    if (g_ws == nullptr) {
+        write_log("Send dropped: WebSocket not connected");
+        return false;
+    }
+    g_pending.push_back(PendingFrame{ std::move(frame), steady_clock::now() });
+
+    const std::size_t depth = g_depth.fetch_add(1, std::memory_order_relaxed) + 1;
+    std::size_t prev = g_max_depth.load(std::memory_order_relaxed);
+    while (depth > prev && !g_max_depth.compare_exchange_weak(prev, depth, std::memory_order_relaxed)) {
+    }
+
+    if (!g_write_active) {
+        g_write_active = true;
+        asio::post(g_ws->get_executor(), [] { take_batch(); });
+    }
+    return true;
+}
+
+std::string ws_send_stats()
+{
+    return "send queue depth=" + std::to_string(g_depth.load(std::memory_order_relaxed))
+        + " max_depth=" + std::to_string(g_max_depth.load(std::memory_order_relaxed))
+        + " failed=" + std::to_string(g_failed.load(std::memory_order_relaxed))
+        + " write latency " + g_write_latency.summary();
+}
@@ -0,0 +1,22 @@
+﻿#pragma once
+#include "ws_transport.h"
+#include <functional>
+#include <string>
+
+// 绑定发送端：所有写操作都投递到 ws 所属的 io_context 上，由唯一的写者串行执行
+// 某帧写失败时本批余下的帧计为失败，写者停止并关闭连接，之后的帧在重连解绑时丢弃
+void ws_send_attach(ws_stream* ws);
+
+// 以进程内回调代替 ws 连接（回放 / 压测工具使用）：绑定后 ws_send 在调用线程上直接把帧交给 sink
+// 绑定 / 解绑可与发送并发；sink 在各发送线程上被调用，需自行保证线程安全；ws_send_detach 同时解绑
+using ws_frame_sink = std::function<void(std::string frame)>;
+void ws_send_attach_sink(ws_frame_sink sink);
+
+// 解绑发送端（连接断开后、ws 析构前调用），未发出的帧会被丢弃
+void ws_send_detach();
+
+// 投递一帧已序列化的消息，任意线程均可调用，不阻塞在 socket 上；未连接时丢弃并返回 false
+bool ws_send(std::string frame);
+
+// 统计摘要：当前/最大队列深度、入队到写完的延迟
+std::string ws_send_stats();
@@ -0,0 +1,229 @@
+﻿#include "ws_session.h"
+#include "config.h"
+#include "utils.h"
+#include "frame_router.h"
+#include "frame_classifier.h"
+#include "ws_send_queue.h"
+#include "onebot_rpc.h"
+#include "outbound_scheduler.h"
+#include "ws_transport.h"
+#include "frame_capture.h"
+#include "alloc_counter.h"
+#include "stats.h"
+#include <boost/asio.hpp>
+#include <boost/beast.hpp>
+#include <algorithm>
+
+namespace asio = boost::asio;
+namespace beast = boost::beast;
+namespace websocket = beast::websocket;
+using tcp = asio::ip::tcp;
+using steady_clock = std::chrono::steady_clock;
+
+namespace {
+
+struct Session {
+    asio::io_context ioc;
+    ws_stream ws{ ioc };
+    beast::flat_buffer buffer;
+    asio::steady_timer watchdog{ ioc };
+    asio::steady_timer stats_timer{ ioc };
+    asio::steady_timer rpc_timer{ ioc };
+
+    steady_clock::time_point last_heartbeat = steady_clock::now();
+    long long heartbeat_interval_ms = HEARTBEAT_DEFAULT_INTERVAL_MS;
+    unsigned long long heartbeats = 0;
+    unsigned long long pongs = 0;
+    SampleStat decode_allocs; // 每帧解码 + 派发的堆分配次数（仅 QQBOT_ALLOC_COUNTER 诊断构建）
+
+    websocket::response_type handshake_res;
+    bool connected = false;
+    steady_clock::time_point connected_at;
+    // 会话进入收尾后置位：cancel 对已到期、回调已排队的定时器无效（回调仍以 ec == 0 运行），
+    // 各定时器回调须据此不再重新挂起，否则 ioc.run() 永不返回、监督器等不到重连
+    bool stopping = false;
+
+    void start_connect(const tcp::resolver::results_type& endpoints) {
+        beast::get_lowest_layer(ws).expires_after(std::chrono::seconds(10));
+        beast::get_lowest_layer(ws).async_connect(endpoints,
+            [this](beast::error_code ec, const tcp::endpoint&) {
+                if (ec) {
+                    write_log("WebSocket connection failed: " + ec.message() + ", Error code: " + std::to_string(ec.value()));
+                    return;
+                }
+                beast::get_lowest_layer(ws).expires_never(); // 之后的超时交由 websocket 层管理
+                start_handshake();
+            });
+    }
+
+    void start_handshake() {
+        // 空闲一半时间后自动发送 ping，超时仍无任何数据则读取以 timeout 失败
+        websocket::stream_base::timeout opt{
+            std::chrono::seconds(10),                  // handshake_timeout
+            std::chrono::seconds(WS_IDLE_TIMEOUT_SEC), // idle_timeout
+            true                                       // keep_alive_pings
+        };
+        ws.set_option(opt);
+        ws.control_callback([this](websocket::frame_type kind, beast::string_view) {
+            if (kind == websocket::frame_type::pong) ++pongs;
+        });
+        ws.async_handshake(handshake_res, WS_HOST, WS_PATH, [this](beast::error_code ec) {
+            if (ec) {
+                write_log("WebSocket handshake failed: " + ec.message() + ", Error code: " + std::to_string(ec.value()));
+                return;
+            }
+            on_connected();
+        });
+    }
+
+    void on_connected() {
+        ws.text(true);
+        auto ext = handshake_res.find(beast::http::field::sec_websocket_extensions);
+        write_log("WebSocket extensions negotiated: "
+            + (ext == handshake_res.end() ? std::string("<none>") : std::string(ext->value())));
+
+        connected = true;
+        connected_at = steady_clock::now();
+        write_log("WebSocket connected successfully! Robot started, QQ: " + std::string(BOT_QQ));
+        write_log("Waiting for group messages...");
+
+        ws_send_attach(&ws); // 所有出站帧经发送队列由唯一写者写出
+
+        last_heartbeat = connected_at;
+        start_read();
+        start_watchdog();
+        start_stats();
+        start_rpc_sweep();
+    }
+
+    // 异步读循环：一帧读完后只做解码与派发，随即发起下一次读取，不等待业务处理
+    // buffer 跨读取复用（clear 不释放容量），帧数据直接在其连续内存上解码，不拷贝
+    void start_read() {
+        ws_transport_on_read_start();
+        ws.async_read(buffer, [this](beast::error_code ec, std::size_t bytes) {
+            if (ec) {
+                write_log("WebSocket read failed: " + ec.message() + ", Error code: " + std::to_string(ec.value()));
+                // 会话到此结束：停掉定时器、关闭 socket（挂起的写入随之失败），再直接停止 io_context；
+                // websocket 自身的 ping 计时器在 RST 后不会被取消，不停止的话 run() 要等它到期才返回
+                close_socket();
+                ioc.stop();
+                return;
+            }
+            auto read_at = steady_clock::now();
+            ws_transport_on_frame_read(bytes);
+            const auto allocs_before = alloc_count_this_thread();
+            std::string_view frame(static_cast<const char*>(buffer.data().data()), buffer.size());
+            if (frame_capture_enabled()) {
+                frame_capture_write(frame, read_at); // 先于解码记录，GBK 帧保持原始字节
+            }
+            FrameInfo info = frame_router_on_frame(frame, read_at);
+            if (ALLOC_COUNTER_ENABLED) {
+                decode_allocs.add(static_cast<long long>(alloc_count_this_thread() - allocs_before));
+            }
+            buffer.clear();
+            if (info.kind == FrameKind::Heartbeat) {
+                last_heartbeat = read_at;
+                ++heartbeats;
+                if (info.heartbeat_interval_ms > 0) {
+                    heartbeat_interval_ms = info.heartbeat_interval_ms;
+                }
+            }
+            start_read();
+        });
+    }
+
+    // 心跳看门狗：每秒检查一次距上次 OneBot 心跳的时长
+    // 收到第一次心跳后才生效：NapCat 可关闭心跳，此时链路停滞交给 ping/pong 空闲超时判定
+    void start_watchdog() {
+        watchdog.expires_after(std::chrono::seconds(1));
+        watchdog.async_wait([this](beast::error_code ec) {
+            if (ec || stopping) return;
+            const long long silent_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                steady_clock::now() - last_heartbeat).count();
+            if (heartbeats > 0 && silent_ms > heartbeat_interval_ms * HEARTBEAT_MISS_FACTOR) {
+                write_log("Heartbeat watchdog: no heartbeat for " + std::to_string(silent_ms)
+                    + "ms (interval " + std::to_string(heartbeat_interval_ms) + "ms), closing stalled link");
+                close_socket();
+                return;
+            }
+            start_watchdog();
+        });
+    }
+
+    // 周期统计日志
+    void start_stats() {
+        stats_timer.expires_after(std::chrono::seconds(STATS_LOG_INTERVAL_SEC));
+        stats_timer.async_wait([this](beast::error_code ec) {
+            if (ec || stopping) return;
+            write_log("Stats: " + ws_send_stats() + ", " + ws_transport_stats() + ", heartbeats=" + std::to_string(heartbeats)
+                + " pongs=" + std::to_string(pongs)
+                + (ALLOC_COUNTER_ENABLED ? ", decode allocs/frame " + decode_allocs.summary() : std::string())
+                + ", " + frame_classifier_stats() + ", " + frame_router_stats() + ", " + onebot_rpc_stats()
+                + ", " + outbound_scheduler_stats() + ", " + log_stats()
+                + (frame_capture_enabled() ? ", " + frame_capture_stats() : std::string()));
+            frame_capture_flush();
+            start_stats();
+        });
+    }
+
+    // API 请求期限清扫：超时的待决请求在 io 线程上以 timeout 完成
+    void start_rpc_sweep() {
+        rpc_timer.expires_after(std::chrono::milliseconds(RPC_SWEEP_INTERVAL_MS));
+        rpc_timer.async_wait([this](beast::error_code ec) {
+            if (ec || stopping) return;
+            onebot_rpc_sweep();
+            start_rpc_sweep();
+        });
+    }
+
+    void stop_timers() {
+        stopping = true;
+        watchdog.cancel();
+        stats_timer.cancel();
+        rpc_timer.cancel();
+    }
+
+    // 直接关闭底层 socket，挂起的读取随之失败并结束会话
+    void close_socket() {
+        stop_timers();
+        beast::error_code ignored;
+        beast::get_lowest_layer(ws).socket().shutdown(tcp::socket::shutdown_both, ignored);
+        beast::get_lowest_layer(ws).close();
+    }
+};
+
+} // namespace
+
+WsSessionResult ws_session_run()
+{
+    WsSessionResult result;
+    Session s;
+    tcp::resolver::results_type endpoints;
+    try {
+        tcp::resolver resolver(s.ioc);
+        endpoints = resolver.resolve(WS_HOST, WS_PORT);
+    }
+    catch (const beast::system_error& e) {
+        write_log("WebSocket resolve failed: " + std::string(e.what()) + ", Error code: " + std::to_string(e.code().value()));
+        return result;
+    }
+
+    // 连接与握手同样走异步路径，握手阶段读到的字节也计入线上字节统计
+    ws_transport_configure_deflate(s.ws);
+    s.start_connect(endpoints);
+    try {
+        s.ioc.run(); // 读失败时停止 io_context，run() 随之返回
+    }
+    catch (const std::exception& e) {
+        write_log("Session exception: " + std::string(e.what()));
+    }
+
+    frame_capture_flush();
+    if (s.connected) {
+        ws_send_detach();
+        onebot_rpc_fail_all("disconnected"); // 回执不会再到达，不必等到期限
+        result.connected = true;
+        result.uptime = steady_clock::now() - s.connected_at;
+    }
+    return result;
+}
@@ -0,0 +1,12 @@
+﻿#pragma once
+#include <chrono>
+
+// 一次连接会话的结果，供重连监督器决定退避
+struct WsSessionResult {
+    bool connected = false;                              // 握手是否成功
+    std::chrono::steady_clock::duration uptime{};        // 握手成功到断开的时长
+};
+
+// 建立连接并运行异步读循环，直到连接断开（读失败 / ping 超时 / 心跳看门狗判定停滞）才返回
+// 会话期间出站帧经发送队列写出；各业务模块的内存状态不随会话重建
+WsSessionResult ws_session_run();
@@ -0,0 +1,92 @@
+﻿#include "ws_transport.h"
+#include "config.h"
+#include "stats.h"
+#include "pipeline_stats.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+
+using steady_clock = std::chrono::steady_clock;
+
+namespace {
+
+struct DirectionCounters {
+    std::atomic<unsigned long long> wire_bytes{ 0 };
+    std::atomic<unsigned long long> payload_bytes{ 0 };
+    std::atomic<unsigned long long> frames{ 0 };
+};
+
+DirectionCounters g_in;
+DirectionCounters g_out;
+LatencyStat g_frame_read_time;
+
+// 以下两个变量只在 io 线程（读循环）访问
+bool g_waiting_first_byte = false;
+steady_clock::time_point g_first_byte_at;
+
+std::string direction_summary(const char* name, const DirectionCounters& c) {
+    const unsigned long long wire = c.wire_bytes.load(std::memory_order_relaxed);
+    const unsigned long long payload = c.payload_bytes.load(std::memory_order_relaxed);
+    char ratio[32];
+    std::snprintf(ratio, sizeof(ratio), "%.2f", payload == 0 ? 1.0 : static_cast<double>(wire) / static_cast<double>(payload));
+    return std::string(name) + " frames=" + std::to_string(c.frames.load(std::memory_order_relaxed))
+        + " wire=" + std::to_string(wire) + "B payload=" + std::to_string(payload) + "B ratio=" + ratio;
+}
+
+} // namespace
+
+void counting_rate_policy::transfer_read_bytes(std::size_t n) noexcept
+{
+    g_in.wire_bytes.fetch_add(n, std::memory_order_relaxed);
+    if (g_waiting_first_byte && n > 0) {
+        g_waiting_first_byte = false;
+        g_first_byte_at = steady_clock::now();
+    }
+}
+
+void counting_rate_policy::transfer_write_bytes(std::size_t n) noexcept
+{
+    g_out.wire_bytes.fetch_add(n, std::memory_order_relaxed);
+}
+
+void ws_transport_configure_deflate(ws_stream& ws)
+{
+    websocket::permessage_deflate pmd;
+    pmd.client_enable = WS_DEFLATE_ENABLE;
+    pmd.client_max_window_bits = WS_DEFLATE_CLIENT_MAX_WINDOW_BITS;
+    pmd.server_max_window_bits = WS_DEFLATE_SERVER_MAX_WINDOW_BITS;
+    pmd.compLevel = WS_DEFLATE_COMP_LEVEL;
+    pmd.memLevel = WS_DEFLATE_MEM_LEVEL;
+    ws.set_option(pmd);
+}
+
+void ws_transport_on_read_start()
+{
+    g_waiting_first_byte = true;
+}
+
+void ws_transport_on_frame_read(std::size_t payload_bytes)
+{
+    g_in.payload_bytes.fetch_add(payload_bytes, std::memory_order_relaxed);
+    g_in.frames.fetch_add(1, std::memory_order_relaxed);
+    // 整帧已在缓冲中（上一次 socket 读取一并带回）时没有首字节时刻，不计入耗时
+    if (!g_waiting_first_byte) {
+        const long long us = std::chrono::duration_cast<std::chrono::microseconds>(
+            steady_clock::now() - g_first_byte_at).count();
+        g_frame_read_time.add(us);
+        pipeline_record(PipelineStage::Read, us);
+    }
+    g_waiting_first_byte = false;
+}
+
+void ws_transport_on_frame_written(std::size_t payload_bytes)
+{
+    g_out.payload_bytes.fetch_add(payload_bytes, std::memory_order_relaxed);
+    g_out.frames.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::string ws_transport_stats()
+{
+    return direction_summary("in", g_in) + ", " + direction_summary("out", g_out)
+        + ", frame read time " + g_frame_read_time.summary();
+}
@@ -0,0 +1,36 @@
+﻿#pragma once
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <limits>
+#include <string>
+
+namespace websocket = boost::beast::websocket;
+
+// 统计底层 TCP 实际收发字节数的速率策略（不限速，只计数）
+// 与帧载荷字节数对比即可得到 permessage-deflate 的压缩效果
+class counting_rate_policy {
+    friend class boost::beast::rate_policy_access;
+
+    std::size_t available_read_bytes() const noexcept { return (std::numeric_limits<std::size_t>::max)(); }
+    std::size_t available_write_bytes() const noexcept { return (std::numeric_limits<std::size_t>::max)(); }
+    void transfer_read_bytes(std::size_t n) noexcept;
+    void transfer_write_bytes(std::size_t n) noexcept;
+    void on_timer() noexcept {}
+};
+
+using ws_tcp_stream = boost::beast::basic_stream<boost::asio::ip::tcp, boost::asio::any_io_executor, counting_rate_policy>;
+using ws_stream = websocket::stream<ws_tcp_stream>;
+
+// 按 config.h 配置为 ws 提供 permessage-deflate 扩展（服务端不支持时自动回退为不压缩）
+void ws_transport_configure_deflate(ws_stream& ws);
+
+// 读循环在发起一次 async_read 前调用，用于计算单帧读取耗时（首个字节到达 -> 整帧解压完成）
+void ws_transport_on_read_start();
+// 一帧读取完成：payload_bytes 为解压后的载荷大小
+void ws_transport_on_frame_read(std::size_t payload_bytes);
+// 一帧写出完成：payload_bytes 为压缩前的载荷大小
+void ws_transport_on_frame_written(std::size_t payload_bytes);
+
+// 统计摘要：分方向的线上字节 / 载荷字节 / 压缩比，以及单帧读取耗时
+std::string ws_transport_stats();
@@ -1,8 +1,8 @@
-﻿#include "reply_generator.h"
+﻿#include "class_inquiry.h"
 #include "config.h"
 #include "utils.h"
 #include "schedule.h"
-#include "schedule_loader.h"
+#include "schedule_store.h"
 #include "schedule_reminder.h"
 #include "group_mapping.h"
 #include "member_cache.h"
@@ -15,9 +15,6 @@
 #include <sstream>
 #include <iomanip>
 
-// 全局常量定义
-static const char* SCHEDULE_FILE = "persistent_schedules.json";
-
 // 获取当前时间对应的节次（按冬季/夏季作息自动适配）
 static int get_current_class_period() {
     std::time_t now = std::time(nullptr);
@@ -25,7 +22,7 @@ static int get_current_class_period() {
 #if defined(_MSC_VER)
     localtime_s(&current_time, &now);
 #else
-    current_time = *std::localtime(&now);
+    localtime_r(&now, &current_time);
 #endif
     current_time.tm_isdst = -1;
     std::mktime(&current_time);
@@ -63,7 +60,7 @@ static std::string get_next_class_info(const std::string& qq_number) {
 #if defined(_MSC_VER)
     localtime_s(&current_time, &now);
 #else
-    current_time = *std::localtime(&now);
+    localtime_r(&now, &current_time);
 #endif
     current_time.tm_isdst = -1;
     std::mktime(&current_time);
@@ -199,7 +196,8 @@ static int calc_minutes_left_and_end_str(const std::tm& today, const Schedule& c
 
 // 新增：获取“下一节课”的详细信息（课程+日期+距上课分钟+开始时刻）
 // 返回 true 表示找到
-static bool get_next_class_detail(const std::string& qq_number,
+static bool get_next_class_detail(const ScheduleSnapshot& snapshot,
+                                  const std::string& qq_number,
                                   const std::tm& now_tm,
                                   Schedule& out_course,
                                   std::tm& out_date,
@@ -211,7 +209,7 @@ static bool get_next_class_detail(const std::string& qq_number,
         target_date.tm_mday += day_offset;
         std::mktime(&target_date);
 
-        auto courses = ScheduleReminder::get_courses_on_date(qq_number, target_date);
+        auto courses = ScheduleReminder::get_courses_on_date(snapshot, qq_number, target_date);
         if (courses.empty()) continue;
 
         // 按节次排序
@@ -250,32 +248,28 @@ static bool get_next_class_detail(const std::string& qq_number,
 }
 
 // 获取群内所有绑定用户的上课状态
-std::vector<ReplyRule> get_class_inquiry_rules() {
-    std::vector<ReplyRule> rules;
-
+void register_class_inquiry_commands(CommandRegistry& registry) {
     // 规则：@bot + "有谁在上课" → 查询当前群内上课状态
-    rules.push_back(ReplyRule{
-        [](const json& msg_data, const std::string& content) {
-            return is_at_bot(msg_data) && content == u8"有谁在上课";
-        },
-        [](const std::string& group_id, const std::string&) -> std::string {
+    registry.add_exact(u8"有谁在上课", Command{
+        [](const MessageContext& ctx) -> std::string {
+            const std::string& group_id = ctx.group_id_str;
             // 仅允许“绑定群聊”的群查询
             auto qs = get_query_groups();
             if (qs.find(group_id) == qs.end()) {
                 return u8"本群尚未绑定查询群功能，请发送「绑定群聊」。";
             }
 
-            // 1) 读取已导入课表的所有用户
-            auto all_schedules = ScheduleLoader::load_from_file(SCHEDULE_FILE);
+            // 1) 取一次课表快照，本次查询的所有用户都在同一版本上计算
+            const auto snapshot = ScheduleStore::snapshot();
 
             // 2) 从成员缓存中获取“当前群内的已记录成员”
             //    仅将“已导入课表”的成员纳入统计
-            std::vector<std::string> group_users;
+            std::vector<std::pair<std::string, const UserSchedules*>> group_users;
             auto cached_members = get_group_member_qqs(group_id);
             group_users.reserve(cached_members.size());
             for (const auto& qq : cached_members) {
-                if (all_schedules.find(qq) != all_schedules.end()) {
-                    group_users.push_back(qq);
+                if (const UserSchedules* user = snapshot->find_user(qq)) {
+                    group_users.emplace_back(qq, user);
                 }
             }
 
@@ -289,7 +283,7 @@ std::vector<ReplyRule> get_class_inquiry_rules() {
 #if defined(_MSC_VER)
             localtime_s(&current_time, &now);
 #else
-            current_time = *std::localtime(&now);
+            localtime_r(&now, &current_time);
 #endif
             current_time.tm_isdst = -1;
             std::mktime(&current_time);
@@ -317,14 +311,28 @@ std::vector<ReplyRule> get_class_inquiry_rules() {
             std::vector<InClassInfo> in_class_infos;
             std::vector<FreeInfo> free_infos;
 
-            for (const std::string& qq : group_users) {
-                std::vector<Schedule> today_courses = ScheduleReminder::get_courses_on_date(qq, current_time);
-                const Schedule* the_course = nullptr;
+            // 当前周次与星期对整群只算一次，每个成员“是否正在上课”为占用字上的一次位测试
+            // 索引不完整（有课超出索引的周次 / 节次范围）的成员回退为逐门扫描当天课程
+            const int week = ScheduleReminder::get_week_of_term(current_time);
+            const int weekday = current_time.tm_wday == 0 ? 7 : current_time.tm_wday;
+            const uint16_t period_bit = occupancy_period_bit(current_period);
+            std::vector<Schedule> today_courses;
 
-                for (const auto& course : today_courses) {
-                    if (course.get_start_class() <= current_period && course.get_end_class() >= current_period) {
-                        the_course = &course;
-                        break;
+            for (const auto& member : group_users) {
+                const std::string& qq = member.first;
+                const UserSchedules& user = *member.second;
+                const Schedule* the_course = nullptr;
+                if (user.occupancy.complete()) {
+                    if (user.occupancy.day_mask(week, weekday) & period_bit) {
+                        the_course = &user.courses[user.occupancy.course_at(week, weekday, current_period)];
+                    }
+                } else {
+                    today_courses = ScheduleReminder::get_courses_on_date(*snapshot, qq, current_time);
+                    for (const auto& course : today_courses) {
+                        if (course.get_start_class() <= current_period && course.get_end_class() >= current_period) {
+                            the_course = &course;
+                            break;
+                        }
                     }
                 }
 
@@ -337,7 +345,7 @@ std::vector<ReplyRule> get_class_inquiry_rules() {
                     std::tm nd{};
                     std::string start_clock;
                     int minutes_to_start = 0;
-                    if (get_next_class_detail(qq, current_time, nc, nd, start_clock, minutes_to_start)) {
+                    if (get_next_class_detail(*snapshot, qq, current_time, nc, nd, start_clock, minutes_to_start)) {
                         free_infos.push_back(FreeInfo{ qq, nc, nd, minutes_to_start, start_clock });
                     } else {
                         FreeInfo none{ qq, Schedule(), std::tm{}, -1, "" };
@@ -424,7 +432,5 @@ std::vector<ReplyRule> get_class_inquiry_rules() {
 
             return reply.str();
         }
-        });
-
-    return rules;
+    });
 }
\ No newline at end of file
@@ -1,9 +1,9 @@
 ﻿#pragma once
 #ifndef CLASS_INQUIRY_H
 #define CLASS_INQUIRY_H
-#include "reply_generator.h"
+#include "command_registry.h"
 
-// 获取"有谁在上课"查询规则
-std::vector<ReplyRule> get_class_inquiry_rules();
+// 注册"有谁在上课"查询指令
+void register_class_inquiry_commands(CommandRegistry& registry);
 
 #endif // CLASS_INQUIRY_H
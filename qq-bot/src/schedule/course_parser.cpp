@@ -0,0 +1,115 @@
+﻿#include "course_parser.h"
+#include "utils.h"
+#include <algorithm>
+#include <sstream>
+
+// 解析单条课程字符串：格式 "课程名，星期，开始周，结束周，开始节，结束节"
+// 优先使用中文逗号“，”分割，兼容英文逗号“,”
+bool parse_course_str(const std::string& content, Schedule& out_schedule, const std::string& qq_number) {
+    auto replace_all = [](std::string& s, const std::string& from, const std::string& to) {
+        if (from.empty()) return;
+        size_t pos = 0;
+        while ((pos = s.find(from, pos)) != std::string::npos) {
+            s.replace(pos, from.size(), to);
+            pos += to.size();
+        }
+    };
+
+    auto split_parts = [&](const std::string& s) {
+        const std::string cn_comma = u8"，";
+        std::vector<std::string> parts;
+        std::string normalized = s;
+
+        // 如果包含中文逗号，用中文逗号替换为英文逗号；否则直接用英文逗号
+        if (normalized.find(cn_comma) != std::string::npos) {
+            replace_all(normalized, cn_comma, ",");
+        }
+
+        std::stringstream ss(normalized);
+        std::string part;
+        while (std::getline(ss, part, ',')) {
+            part = trim_space(part);
+            if (!part.empty()) parts.push_back(part);
+        }
+        return parts;
+    };
+
+    std::vector<std::string> parts = split_parts(content);
+    if (parts.size() != 6) {
+        return false;
+    }
+    try {
+        int weekday = std::stoi(parts[1]);
+        int start_week = std::stoi(parts[2]);
+        int end_week = std::stoi(parts[3]);
+        int start_class = std::stoi(parts[4]);
+        int end_class = std::stoi(parts[5]);
+        if (weekday < 1 || weekday > 7 ||
+            start_week < 1 || end_week < start_week ||
+            start_class < 1 || end_class < start_class) {
+            return false;
+        }
+        out_schedule = Schedule(start_week, end_week, start_class, end_class, weekday, parts[0], qq_number);
+        return true;
+    }
+    catch (...) {
+        return false;
+    }
+}
+
+// 将导入文本拆分为多条记录，支持换行或中文分号“；”分隔
+std::vector<std::string> split_records(const std::string& content) {
+    const std::string cn_semicolon = u8"；";
+    std::vector<std::string> records;
+    std::string current;
+    current.reserve(content.size());
+
+    for (size_t i = 0; i < content.size(); ++i) {
+        char ch = content[i];
+        if (ch == '\r') continue; // 忽略 \r
+
+        // 按 UTF-8 子串匹配中文分号
+        if (content.compare(i, cn_semicolon.size(), cn_semicolon) == 0) {
+            std::string trimmed = trim_space(current);
+            if (!trimmed.empty()) records.push_back(trimmed);
+            current.clear();
+            i += cn_semicolon.size() - 1; // 跳过中文分号的剩余字节
+        }
+        else if (ch == '\n') {
+            std::string trimmed = trim_space(current);
+            if (!trimmed.empty()) records.push_back(trimmed);
+            current.clear();
+        }
+        else {
+            current.push_back(ch);
+        }
+    }
+    std::string trimmed = trim_space(current);
+    if (!trimmed.empty()) records.push_back(trimmed);
+    return records;
+}
+
+// 判断是否可能为“导入课表”消息：至少包含一条记录且每条记录包含5个中文逗号（或兼容英文逗号）
+bool is_course_import_message(const std::string& content) {
+    auto count_substr = [](const std::string& s, const std::string& sub) {
+        size_t count = 0;
+        size_t pos = 0;
+        while ((pos = s.find(sub, pos)) != std::string::npos) {
+            ++count;
+            pos += sub.size();
+        }
+        return count;
+    };
+
+    const std::string cn_comma = u8"，";
+    auto records = split_records(content);
+    if (records.empty()) return false;
+    for (const auto& rec : records) {
+        size_t cn_commas = count_substr(rec, cn_comma);
+        size_t en_commas = std::count(rec.begin(), rec.end(), ',');
+        if ((cn_commas == 5) || (en_commas == 5)) {
+            return true;
+        }
+    }
+    return false;
+}
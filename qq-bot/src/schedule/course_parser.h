@@ -0,0 +1,21 @@
+﻿#pragma once
+#ifndef COURSE_PARSER_H
+#define COURSE_PARSER_H
+
+#include "schedule.h"
+#include <string>
+#include <vector>
+
+// 导入课表文本的解析（纯函数，不触碰全局课表），供 schedule_set 与基准测试使用
+
+// 解析单条课程字符串：格式 "课程名，星期，开始周，结束周，开始节，结束节"
+// 优先使用中文逗号“，”分割，兼容英文逗号“,”；格式或取值不合法时返回 false
+bool parse_course_str(const std::string& content, Schedule& out_schedule, const std::string& qq_number);
+
+// 将导入文本拆分为多条记录，支持换行或中文分号“；”分隔（忽略 \r，去除空记录）
+std::vector<std::string> split_records(const std::string& content);
+
+// 判断是否可能为“导入课表”消息：至少一条记录包含5个中文逗号（或5个英文逗号）
+bool is_course_import_message(const std::string& content);
+
+#endif // COURSE_PARSER_H
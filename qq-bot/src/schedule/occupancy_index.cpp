@@ -0,0 +1,55 @@
+﻿#include "occupancy_index.h"
+#include <algorithm>
+#include <numeric>
+
+OccupancyIndex::OccupancyIndex(const std::vector<Schedule>& courses) {
+    for (const auto& c : courses) {
+        weeks_ = (std::max)(weeks_, (std::min)(c.get_end_week(), OCCUPANCY_MAX_WEEKS));
+        if (c.get_end_week() > OCCUPANCY_MAX_WEEKS || c.get_end_class() > OCCUPANCY_PERIODS ||
+            c.get_weekday() < 1 || c.get_weekday() > 7) {
+            complete_ = false;
+        }
+    }
+    if (weeks_ <= 0 || courses.size() >= NO_COURSE) {
+        weeks_ = 0;
+        complete_ = courses.empty();
+        return;
+    }
+    days_.assign(static_cast<size_t>(weeks_) * 7, 0);
+    slots_.assign(days_.size() * OCCUPANCY_PERIODS, NO_COURSE);
+
+    // 按开始节、结束节、课程名排序后依次占位，已占用的节不覆盖
+    std::vector<uint16_t> order(courses.size());
+    std::iota(order.begin(), order.end(), static_cast<uint16_t>(0));
+    std::stable_sort(order.begin(), order.end(), [&](uint16_t a, uint16_t b) {
+        const Schedule& x = courses[a];
+        const Schedule& y = courses[b];
+        if (x.get_start_class() != y.get_start_class()) return x.get_start_class() < y.get_start_class();
+        if (x.get_end_class() != y.get_end_class()) return x.get_end_class() < y.get_end_class();
+        return x.get_name() < y.get_name();
+    });
+
+    for (uint16_t id : order) {
+        const Schedule& c = courses[id];
+        const int weekday = c.get_weekday();
+        if (weekday < 1 || weekday > 7) continue;
+        const int first_period = (std::max)(c.get_start_class(), 1);
+        const int last_period = (std::min)(c.get_end_class(), OCCUPANCY_PERIODS);
+        const int last_week = (std::min)(c.get_end_week(), weeks_);
+        for (int week = (std::max)(c.get_start_week(), 1); week <= last_week; ++week) {
+            const size_t day = static_cast<size_t>(week - 1) * 7 + (weekday - 1);
+            for (int period = first_period; period <= last_period; ++period) {
+                uint16_t& slot = slots_[day * OCCUPANCY_PERIODS + (period - 1)];
+                if (slot != NO_COURSE) continue;
+                slot = id;
+                days_[day] |= occupancy_period_bit(period);
+            }
+        }
+    }
+}
+
+uint16_t OccupancyIndex::course_at(int week, int weekday, int period) const {
+    if (!occupied(week, weekday, period)) return NO_COURSE;
+    const size_t day = static_cast<size_t>(week - 1) * 7 + (weekday - 1);
+    return slots_[day * OCCUPANCY_PERIODS + (period - 1)];
+}
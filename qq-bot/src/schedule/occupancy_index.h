@@ -0,0 +1,58 @@
+﻿#pragma once
+#ifndef OCCUPANCY_INDEX_H
+#define OCCUPANCY_INDEX_H
+
+#include "schedule.h"
+#include <cstdint>
+#include <vector>
+
+// 一天最多索引 16 节（一天一个 16 位字，第 n 节对应第 n-1 位）
+constexpr int OCCUPANCY_PERIODS = 16;
+// 最多索引的教学周数：防止“1，1，9999”之类的输入撑大索引；超出部分只在课程列表中
+constexpr int OCCUPANCY_MAX_WEEKS = 64;
+
+// 第 period 节对应的位（period 越界时为 0）
+inline uint16_t occupancy_period_bit(int period) {
+    return (period >= 1 && period <= OCCUPANCY_PERIODS) ? static_cast<uint16_t>(1u << (period - 1)) : 0;
+}
+
+// 单个用户课表的占用索引：每 (周, 星期) 一个 16 位占用字，另有并行的 节 → 课程下标 表
+// 由课表整体构建，构建后只读；用户导入 / 清空时随新的课表对象重建，其他用户不受影响
+class OccupancyIndex {
+public:
+    static constexpr uint16_t NO_COURSE = 0xFFFF;
+
+    OccupancyIndex() = default;
+
+    // courses 中节次重叠时，按“开始节、结束节、课程名”升序先出现的课程占位（与逐门扫描时的选择一致）
+    explicit OccupancyIndex(const std::vector<Schedule>& courses);
+
+    // 索引覆盖的最大周次（0 表示无课程）
+    int weeks() const { return weeks_; }
+
+    // 是否每门课都完整落在索引内（周次不超过 OCCUPANCY_MAX_WEEKS、节次不超过 OCCUPANCY_PERIODS）
+    // 为 true 时占用字为 0 即可断定当天无课
+    bool complete() const { return complete_; }
+
+    // 某周某天的占用字（week 从 1 开始，weekday 为 1-7；越界返回 0）
+    uint16_t day_mask(int week, int weekday) const {
+        if (week < 1 || week > weeks_ || weekday < 1 || weekday > 7) return 0;
+        return days_[static_cast<size_t>(week - 1) * 7 + (weekday - 1)];
+    }
+
+    // 该节是否有课：一次位测试
+    bool occupied(int week, int weekday, int period) const {
+        return (day_mask(week, weekday) & occupancy_period_bit(period)) != 0;
+    }
+
+    // 该节所上课程在 courses 中的下标，无课返回 NO_COURSE
+    uint16_t course_at(int week, int weekday, int period) const;
+
+private:
+    int weeks_ = 0;
+    bool complete_ = true;
+    std::vector<uint16_t> days_;  // [(week-1)*7 + weekday-1]
+    std::vector<uint16_t> slots_; // [((week-1)*7 + weekday-1)*OCCUPANCY_PERIODS + period-1]
+};
+
+#endif // OCCUPANCY_INDEX_H
@@ -2,10 +2,16 @@
 #include "config.h"
 #include "utils.h"
 #include "msg_handler.h"
-#include "reply_generator.h"
+#include "command_registry.h"
 #include <vector>
 #include <string>
 
+// 启动时从持久化文件加载课表到内存（只需调用一次）
+void init_schedules();
+
+// 注册课表指令（导入/查询/清空/今日课程/设置学期）
+void register_schedule_commands(CommandRegistry& registry);
+
 class Schedule {
 private:
     int start_week;
@@ -62,8 +68,6 @@ public:
         j.at("qq_number").get_to(s.qq_number);
     }
 
-    std::vector<ReplyRule> get_schedule_rules();
-
     // 使用 UTF-8 字面量
     std::string to_string() const {
         return std::string(u8"课程：") + name +
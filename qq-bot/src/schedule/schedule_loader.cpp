@@ -1,4 +1,5 @@
 ﻿#include "schedule_loader.h"
+#include "utf8.h"
 #include <nlohmann/json.hpp>
 #include <fstream>
 #include <sstream>
@@ -6,52 +7,8 @@
 
 using json = nlohmann::json;
 
-namespace {
-    // 简单 UTF-8 校验（兼容 C++14）
-    bool utf8_validate(const std::string& s) {
-        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(s.data());
-        size_t i = 0;
-        const size_t len = s.size();
-        while (i < len) {
-            unsigned char c = bytes[i];
-            if ((c & 0x80) == 0) {
-                i += 1;
-            } else if ((c & 0xE0) == 0xC0) {
-                if (i + 1 >= len) return false;
-                unsigned char c1 = bytes[i + 1];
-                if ((c1 & 0xC0) != 0x80) return false;
-                unsigned int cp = ((c & 0x1F) << 6) | (c1 & 0x3F);
-                if (cp < 0x80) return false;
-                i += 2;
-            } else if ((c & 0xF0) == 0xE0) {
-                if (i + 2 >= len) return false;
-                unsigned char c1 = bytes[i + 1];
-                unsigned char c2 = bytes[i + 2];
-                if ((c1 & 0xC0) != 0x80 || (c2 & 0xC0) != 0x80) return false;
-                unsigned int cp = ((c & 0x0F) << 12) | ((c1 & 0x3F) << 6) | (c2 & 0x3F);
-                if (cp < 0x800) return false;
-                if (cp >= 0xD800 && cp <= 0xDFFF) return false;
-                i += 3;
-            } else if ((c & 0xF8) == 0xF0) {
-                if (i + 3 >= len) return false;
-                unsigned char c1 = bytes[i + 1];
-                unsigned char c2 = bytes[i + 2];
-                unsigned char c3 = bytes[i + 3];
-                if ((c1 & 0xC0) != 0x80 || (c2 & 0xC0) != 0x80 || (c3 & 0xC0) != 0x80) return false;
-                unsigned int cp = ((c & 0x07) << 18) | ((c1 & 0x3F) << 12) | ((c2 & 0x3F) << 6) | (c3 & 0x3F);
-                if (cp < 0x10000) return false;
-                if (cp > 0x10FFFF) return false;
-                i += 4;
-            } else {
-                return false;
-            }
-        }
-        return true;
-    }
-}
-
 bool ScheduleLoader::is_valid_utf8(const std::string& s) {
-    return utf8_validate(s);
+    return utf8_is_valid(s);
 }
 
 std::string ScheduleLoader::dump_hex(const std::string& s, size_t max_len) {
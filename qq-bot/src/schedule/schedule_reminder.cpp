@@ -1,16 +1,36 @@
 ﻿#include "schedule_reminder.h"
 #include "utils.h"
-#include "schedule_loader.h"
 #include <iomanip>
 #include <sstream>
 #include <algorithm>
+#include <atomic>
 #include <ctime>
 #include <fstream>
+#include <mutex>
 
-static const char* SCHEDULE_FILE = "persistent_schedules.json";
 static const char* TERM_START_FILE = "term_start_date.txt";
 
-std::tm ScheduleReminder::term_start_date = []() {
+// 学期开始日期可能在某个群的分片线程上被修改；写入互斥，读者只读 term_start_day（原子）
+static std::mutex term_start_mtx;
+
+// 公历日期 → 自 1970-01-01 起的天数（days_from_civil 算法），纯整数运算，不经 mktime 与时区
+static long long days_from_civil(long long y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const long long era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<long long>(doe) - 719468;
+}
+
+static long long day_number(const std::tm& date) {
+    return days_from_civil(date.tm_year + 1900LL, static_cast<unsigned>(date.tm_mon + 1), static_cast<unsigned>(date.tm_mday));
+}
+
+// 学期第一周起始日的天数：每次算周次只需一次整数相减（随 term_start_date 一起更新）
+static std::atomic<long long> term_start_day{ 0 };
+
+static std::tm load_term_start_date() {
     // 默认值：2024-09-02
     auto fallback = []() {
         std::tm tm{};
@@ -51,6 +71,12 @@ std::tm ScheduleReminder::term_start_date = []() {
     std::mktime(&tm);
     write_log(u8"已从持久化文件加载学期开始日期: " + content);
     return tm;
+}
+
+std::tm ScheduleReminder::term_start_date = []() {
+    std::tm tm = load_term_start_date();
+    term_start_day.store(day_number(tm), std::memory_order_relaxed);
+    return tm;
 }();
 
 ScheduleType ScheduleReminder::get_schedule_type(const std::tm& date) {
@@ -63,19 +89,7 @@ ScheduleType ScheduleReminder::get_schedule_type(const std::tm& date) {
 }
 
 int ScheduleReminder::get_week_of_term(const std::tm& date) {
-    std::tm start = term_start_date;
-    std::tm target = date;
-    start.tm_hour = start.tm_min = start.tm_sec = 0;
-    target.tm_hour = target.tm_min = target.tm_sec = 0;
-    start.tm_isdst = -1;
-    target.tm_isdst = -1;
-
-    std::time_t t_start = std::mktime(&start);
-    std::time_t t_target = std::mktime(&target);
-
-    double seconds = std::difftime(t_target, t_start);
-    long long days = static_cast<long long>(seconds / 86400.0);
-
+    const long long days = day_number(date) - term_start_day.load(std::memory_order_relaxed);
     int week = static_cast<int>(days / 7) + 1;
     if (week < 1) {
         week = 1;
@@ -83,14 +97,11 @@ int ScheduleReminder::get_week_of_term(const std::tm& date) {
     return week;
 }
 
-bool ScheduleReminder::is_course_on_date(const Schedule& course, const std::tm& date) {
-    int current_week = get_week_of_term(date);
-    if (current_week < course.get_start_week() || current_week > course.get_end_week()) {
+bool ScheduleReminder::is_course_on_date(const Schedule& course, int week, int weekday) {
+    if (week < course.get_start_week() || week > course.get_end_week()) {
         return false;
     }
-    int course_weekday = course.get_weekday();
-    int date_weekday = date.tm_wday == 0 ? 7 : date.tm_wday;
-    return course_weekday == date_weekday;
+    return course.get_weekday() == weekday;
 }
 
 bool ScheduleReminder::set_term_start_date(const std::string& date_str) {
@@ -119,7 +130,11 @@ bool ScheduleReminder::set_term_start_date(const std::string& date_str) {
 
     tm.tm_hour = 0; tm.tm_min = 0; tm.tm_sec = 0; tm.tm_isdst = -1;
     std::mktime(&tm);
-    term_start_date = tm;
+    {
+        std::lock_guard<std::mutex> lock(term_start_mtx);
+        term_start_date = tm;
+        term_start_day.store(day_number(tm), std::memory_order_relaxed);
+    }
 
     // 持久化覆盖写入
     std::ofstream ofs(TERM_START_FILE, std::ios::out | std::ios::trunc | std::ios::binary);
@@ -142,16 +157,30 @@ std::vector<Schedule> ScheduleReminder::get_courses_on_date(
     const std::string& qq_number,
     const std::tm& target_date
 ) {
-    auto all_schedules = ScheduleLoader::load_from_file(SCHEDULE_FILE);
-    auto it = all_schedules.find(qq_number);
-    if (it == all_schedules.end()) {
+    return get_courses_on_date(*ScheduleStore::snapshot(), qq_number, target_date);
+}
+
+std::vector<Schedule> ScheduleReminder::get_courses_on_date(
+    const ScheduleSnapshot& snapshot,
+    const std::string& qq_number,
+    const std::tm& target_date
+) {
+    const UserSchedules* user = snapshot.find_user(qq_number);
+    if (user == nullptr) {
+        return {};
+    }
+
+    // 周次对整次查询只算一次；占用索引完整且当天占用字为 0 时直接判定无课（提醒批量扫描时多数用户走这里）
+    const int week = get_week_of_term(target_date);
+    const int weekday = target_date.tm_wday == 0 ? 7 : target_date.tm_wday;
+    if (user->occupancy.complete() && user->occupancy.day_mask(week, weekday) == 0) {
         return {};
     }
 
     std::vector<Schedule> result;
-    result.reserve(it->second.size());
-    for (const auto& course : it->second) {
-        if (is_course_on_date(course, target_date)) {
+    result.reserve(user->courses.size());
+    for (const auto& course : user->courses) {
+        if (is_course_on_date(course, week, weekday)) {
             result.push_back(course);
         }
     }
@@ -170,7 +199,7 @@ std::string ScheduleReminder::get_today_courses_reminder(const std::string& qq_n
 #if defined(_MSC_VER)
     localtime_s(&today, &now);
 #else
-    today = *std::localtime(&now);
+    localtime_r(&now, &today);
 #endif
     today.tm_isdst = -1;
     std::mktime(&today);
@@ -214,13 +243,16 @@ std::string ScheduleReminder::get_today_courses_reminder(const std::string& qq_n
 }
 
 std::string ScheduleReminder::get_tomorrow_courses_reminder(const std::string& qq_number) {
+    return get_tomorrow_courses_reminder(*ScheduleStore::snapshot(), qq_number);
+}
+
+std::string ScheduleReminder::get_tomorrow_courses_reminder(const ScheduleSnapshot& snapshot, const std::string& qq_number) {
     std::time_t now = std::time(nullptr);
     std::tm tomorrow{};
 #if defined(_MSC_VER)
     localtime_s(&tomorrow, &now);
 #else
-    std::tm tomorrow_local = *std::localtime(&now);
-    tomorrow = tomorrow_local;
+    localtime_r(&now, &tomorrow);
 #endif
     tomorrow.tm_mday += 1;
     tomorrow.tm_hour = 0;
@@ -229,7 +261,7 @@ std::string ScheduleReminder::get_tomorrow_courses_reminder(const std::string& q
     tomorrow.tm_isdst = -1;
     std::mktime(&tomorrow);
 
-    auto courses = get_courses_on_date(qq_number, tomorrow);
+    auto courses = get_courses_on_date(snapshot, qq_number, tomorrow);
     if (courses.empty()) {
         return with_at(qq_number, u8"明天没有课程哦～");
     }
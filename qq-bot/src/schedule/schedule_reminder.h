@@ -1,5 +1,6 @@
 ﻿#pragma once
 #include "schedule.h"
+#include "schedule_store.h"
 #include <chrono>
 #include <ctime>
 #include <string>
@@ -16,28 +17,36 @@ public:
     // 设置学期第一周开始日期（格式：YYYY-MM-DD）
     static bool set_term_start_date(const std::string& date_str);
 
-    // 获取指定日期的所有课程（按时间排序）
+    // 获取指定日期的所有课程（按时间排序），课表取自当前快照
     static std::vector<Schedule> get_courses_on_date(
         const std::string& qq_number,
         const std::tm& target_date
     );
 
+    // 同上，在调用方持有的快照上查询（一次查询涉及多个用户 / 多天时保证看到同一版本）
+    static std::vector<Schedule> get_courses_on_date(
+        const ScheduleSnapshot& snapshot,
+        const std::string& qq_number,
+        const std::tm& target_date
+    );
+
     // 获取今日课程提醒消息
     static std::string get_today_courses_reminder(const std::string& qq_number);
 
     // 获取明日课程提醒消息（用于晚10点推送）
     static std::string get_tomorrow_courses_reminder(const std::string& qq_number);
+    static std::string get_tomorrow_courses_reminder(const ScheduleSnapshot& snapshot, const std::string& qq_number);
 
     // 根据时间获取当前作息类型
     static ScheduleType get_schedule_type(const std::tm& date);
 
+    // 计算指定日期是学期的第几周（date 须已规范化；按日历日相减，学期开始前按第1周计）
+    static int get_week_of_term(const std::tm& date);
+
 private:
     // 学期第一周的起始日期（用于计算当前周数）
     static std::tm term_start_date;
 
-    // 计算指定日期是学期的第几周
-    static int get_week_of_term(const std::tm& date);
-
-    // 检查课程是否在指定日期上课
-    static bool is_course_on_date(const Schedule& course, const std::tm& date);
+    // 检查课程是否在第 week 周的星期 weekday（1-7）上课
+    static bool is_course_on_date(const Schedule& course, int week, int weekday);
 };
@@ -0,0 +1,101 @@
+﻿#include "schedule_store.h"
+#include "schedule_loader.h"
+#include "utils.h"
+#include <atomic>
+#include <mutex>
+
+// 当前快照：读写均经 std::atomic_load / std::atomic_store，读者拿到的版本在其持有期间保持有效
+static std::shared_ptr<const ScheduleSnapshot> current_snapshot = std::make_shared<const ScheduleSnapshot>();
+// 写者互斥：复制快照、落盘、发布须串行，避免两次导入互相覆盖
+static std::mutex writer_mtx;
+static std::string store_file;
+
+const std::vector<Schedule>* ScheduleSnapshot::find(const std::string& qq) const {
+    const UserSchedules* user = find_user(qq);
+    return user == nullptr ? nullptr : &user->courses;
+}
+
+const UserSchedules* ScheduleSnapshot::find_user(const std::string& qq) const {
+    auto it = users.find(qq);
+    return it == users.end() ? nullptr : it->second.get();
+}
+
+static size_t count_courses(const ScheduleSnapshot& snap) {
+    size_t total = 0;
+    for (const auto& pair : snap.users) {
+        total += pair.second->courses.size();
+    }
+    return total;
+}
+
+// 持久化：保存课表到文件（按 sender_qq），调用方需持有 writer_mtx
+static bool save_snapshot(const ScheduleSnapshot& snap) {
+    std::map<std::string, std::vector<Schedule>> plain;
+    for (const auto& pair : snap.users) {
+        plain.emplace(pair.first, pair.second->courses);
+    }
+    bool success = ScheduleLoader::save_to_file(plain, store_file);
+    if (success) {
+        write_log("Schedules saved, total: " + std::to_string(count_courses(snap)) +
+            " for " + std::to_string(snap.users.size()) + " senders (version " + std::to_string(snap.version) + ")");
+    }
+    else {
+        write_log("Failed to save schedules");
+    }
+    return success;
+}
+
+// 以当前快照为底复制出新版本，只替换 qq 一项，落盘成功后才发布；调用方需持有 writer_mtx
+// 落盘失败时保持当前版本不变并返回 false，避免内存中的改动在重启后悄悄丢失
+static bool publish_user(const std::string& qq, std::shared_ptr<const UserSchedules> user) {
+    const auto base = std::atomic_load(&current_snapshot);
+    auto next = std::make_shared<ScheduleSnapshot>();
+    next->version = base->version + 1;
+    next->users = base->users;
+    next->users[qq] = std::move(user);
+    if (!save_snapshot(*next)) return false;
+    std::atomic_store(&current_snapshot, std::shared_ptr<const ScheduleSnapshot>(std::move(next)));
+    return true;
+}
+
+size_t ScheduleStore::load(const std::string& file_path) {
+    std::lock_guard<std::mutex> lock(writer_mtx);
+    store_file = file_path;
+    auto next = std::make_shared<ScheduleSnapshot>();
+    next->version = std::atomic_load(&current_snapshot)->version + 1;
+    try {
+        for (auto& pair : ScheduleLoader::load_from_file(file_path)) {
+            next->users.emplace(pair.first, std::make_shared<const UserSchedules>(std::move(pair.second)));
+        }
+    }
+    catch (const std::exception& e) {
+        write_log("No existing schedule file, start empty: " + std::string(e.what()));
+        next->users.clear();
+    }
+    const size_t total = count_courses(*next);
+    write_log("Loaded " + std::to_string(total) + " schedules for " + std::to_string(next->users.size()) + " senders");
+    std::atomic_store(&current_snapshot, std::shared_ptr<const ScheduleSnapshot>(std::move(next)));
+    return total;
+}
+
+std::shared_ptr<const ScheduleSnapshot> ScheduleStore::snapshot() {
+    return std::atomic_load(&current_snapshot);
+}
+
+bool ScheduleStore::append(const std::string& qq, const std::vector<Schedule>& courses) {
+    std::lock_guard<std::mutex> lock(writer_mtx);
+    std::vector<Schedule> merged;
+    if (const auto* existing = std::atomic_load(&current_snapshot)->find(qq)) {
+        merged = *existing;
+    }
+    merged.insert(merged.end(), courses.begin(), courses.end());
+    // 只为该用户重建占用索引，其他用户沿用旧版本中的对象
+    return publish_user(qq, std::make_shared<const UserSchedules>(std::move(merged)));
+}
+
+bool ScheduleStore::clear(const std::string& qq) {
+    std::lock_guard<std::mutex> lock(writer_mtx);
+    // 未导入过的用户不新增空项（上课查询以“有条目”判断是否导入过课表）
+    if (std::atomic_load(&current_snapshot)->find(qq) == nullptr) return true;
+    return publish_user(qq, std::make_shared<const UserSchedules>());
+}
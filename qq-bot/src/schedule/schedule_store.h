@@ -0,0 +1,55 @@
+﻿#pragma once
+#ifndef SCHEDULE_STORE_H
+#define SCHEDULE_STORE_H
+
+#include "schedule.h"
+#include "occupancy_index.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 单个用户的课表及其占用索引：发布后不再修改，导入 / 清空时整体替换为新对象（索引随之重建）
+struct UserSchedules {
+    std::vector<Schedule> courses;
+    OccupancyIndex occupancy; // 由 courses 构建，课程下标指向 courses
+
+    UserSchedules() = default;
+    explicit UserSchedules(std::vector<Schedule> c)
+        : courses(std::move(c)), occupancy(courses) {
+    }
+};
+
+// 某一版本的全部课表（不可变）：未变动的用户在新旧版本间共享同一个 UserSchedules
+struct ScheduleSnapshot {
+    uint64_t version = 0;
+    std::map<std::string, std::shared_ptr<const UserSchedules>> users; // 按 sender_qq；清空过的用户保留空课表
+
+    // 用户的课表，未导入过返回 nullptr
+    const std::vector<Schedule>* find(const std::string& qq) const;
+
+    // 用户的课表与占用索引，未导入过返回 nullptr
+    const UserSchedules* find_user(const std::string& qq) const;
+};
+
+// 课表的唯一持有者：内存中保存当前快照，写入时复制并原子替换快照指针
+// 读者（指令处理分片、上课查询、提醒线程）只取一次快照，之后的查询在同一版本上进行，不加锁、不读盘
+// 写者（导入 / 清空）之间互斥，先落盘再发布新版本；落盘失败则不发布，当前版本保持不变
+class ScheduleStore {
+public:
+    // 启动时从持久化文件加载（文件不存在或解析失败时从空课表开始），返回加载的课程总数
+    static size_t load(const std::string& file_path);
+
+    // 当前快照（始终非空；load 之前为空课表）
+    static std::shared_ptr<const ScheduleSnapshot> snapshot();
+
+    // 为用户追加课程并发布新版本；落盘失败时不发布并返回 false
+    static bool append(const std::string& qq, const std::vector<Schedule>& courses);
+
+    // 清空用户课表并发布新版本（保留该用户的空课表条目；未导入过的用户不做改动，返回 true）
+    // 落盘失败时不发布并返回 false
+    static bool clear(const std::string& qq);
+};
+
+#endif // SCHEDULE_STORE_H
@@ -1,23 +1,27 @@
-﻿#include "reply_generator.h"
+﻿#include "guess_number.h"
 #include "config.h"
 #include "utils.h"
+#include "text_normalize.h"
+#include <climits>
 #include <random>
 #include <ctime>
 #include <vector>
 #include <unordered_map>
 
+// 游戏状态只由本群的消息读写，而同一个群的消息总在同一分片线程上处理，
+// 因此放在线程本地：每个分片只持有落在自己身上的群，无需加锁
 // 记录每个群的目标数字
-static std::unordered_map<std::string, int> group_target_num;
+static thread_local std::unordered_map<std::string, int> group_target_num;
 // 记录每个群当前可猜的下界与上界（包含）
-static std::unordered_map<std::string, int> group_low_bound;
-static std::unordered_map<std::string, int> group_high_bound;
+static thread_local std::unordered_map<std::string, int> group_low_bound;
+static thread_local std::unordered_map<std::string, int> group_high_bound;
 
-// 初始化随机数生成器
+// 初始化随机数生成器（每个分片线程一个）
 static std::mt19937 init_rng() {
     std::random_device rd;
     return std::mt19937(rd());
 }
-static std::mt19937 rng = init_rng();
+static thread_local std::mt19937 rng = init_rng();
 
 // 生成1-100随机数
 static int generate_random_num() {
@@ -25,15 +29,38 @@ static int generate_random_num() {
     return dist(rng);
 }
 
-std::vector<ReplyRule> get_guess_number_rules() {
-    std::vector<ReplyRule> rules;
+bool parse_guess_input(std::string_view text, int& value) {
+    size_t i = 0;
+    bool negative = false;
+    if (i < text.size() && (text[i] == '+' || text[i] == '-')) {
+        negative = text[i] == '-';
+        ++i;
+    }
+    if (i == text.size()) return false;
+    // 按负数累加，INT_MIN 也能表示；超出 int 范围视为无效
+    long long acc = 0;
+    for (; i < text.size(); ++i) {
+        if (text[i] < '0' || text[i] > '9') return false;
+        acc = acc * 10 - (text[i] - '0');
+        if (acc < INT_MIN) return false;
+    }
+    if (!negative && acc < -INT_MAX) return false;
+    value = static_cast<int>(negative ? acc : -acc);
+    return true;
+}
 
+bool looks_like_guess_input(const std::string& raw_message) {
+    thread_local std::string text; // 只在 io 线程上调用，缓冲跨消息复用
+    normalize_text_into(raw_message, text, true);
+    int value = 0;
+    return parse_guess_input(text, value);
+}
+
+void register_guess_number_commands(CommandRegistry& registry) {
     // 规则1：@机器人 + "猜数" → 启动游戏
-    rules.push_back(ReplyRule{
-        [](const json& msg_data, const std::string& content) {
-            return is_at_bot(msg_data) && content == u8"猜数";
-        },
-        [](const std::string& group_id) {
+    registry.add_exact(u8"猜数", Command{
+        [](const MessageContext& ctx) -> std::string {
+            const std::string& group_id = ctx.group_id_str;
             int target = generate_random_num();
             group_target_num[group_id] = target; // 记录目标数字
             group_low_bound[group_id] = 1;
@@ -42,29 +69,21 @@ std::vector<ReplyRule> get_guess_number_rules() {
         }
         });
 
-    // 规则2：游戏启动后 + 发送数字 → 判断大小并缩小范围
-    rules.push_back(ReplyRule{
-        [](const json& msg_data, const std::string& content) {
-            std::string group_id = std::to_string(msg_data["group_id"].get<long long>());
-            if (group_target_num.find(group_id) == group_target_num.end()) {
+    // 规则2：游戏启动后 + 发送数字 → 判断大小并缩小范围（无需 @）
+    registry.add_predicate(
+        [](const MessageContext& ctx) {
+            if (group_target_num.find(ctx.group_id_str) == group_target_num.end()) {
                 return false;
             }
-            try {
-                std::stoi(content);
-                return true;
-            }
- catch (...) {
-  return false;
-}
+            int value = 0;
+            return parse_guess_input(ctx.text, value);
 },
-[](const std::string& group_id, const std::string& content) {
-    int user_guess;
-    try {
-        user_guess = std::stoi(content);
+Command{ [](const MessageContext& ctx) -> std::string {
+    const std::string& group_id = ctx.group_id_str;
+    int user_guess = 0;
+    if (!parse_guess_input(ctx.text, user_guess)) {
+        return std::string(u8"请输入有效数字～");
     }
-catch (...) {
- return std::string(u8"请输入有效数字～");
-}
 
 // 当前有效范围
 int low = group_low_bound[group_id];
@@ -100,22 +119,20 @@ else {
     return std::string(u8"恭喜猜对啦！🎉 就是 ") + std::to_string(target) +
         u8" ～ 输入 '猜数' 可重新开始游戏";
 }
-}
-        });
+}, false }, u8"猜数输入");
 
-    // 规则3：游戏启动后 + 发送"退出" → 结束游戏
-    rules.push_back(ReplyRule{
-        [](const json& msg_data, const std::string& content) {
-            std::string group_id = std::to_string(msg_data["group_id"].get<long long>());
-            return is_at_bot(msg_data) && content == u8"退出" && group_target_num.count(group_id) > 0;
-        },
-        [](const std::string& group_id) {
+    // 规则3：@机器人 + 游戏启动后 + 发送"退出" → 结束游戏
+    Command quit{
+        [](const MessageContext& ctx) -> std::string {
+            const std::string& group_id = ctx.group_id_str;
             group_target_num.erase(group_id);
             group_low_bound.erase(group_id);
             group_high_bound.erase(group_id);
             return u8"猜数游戏已退出～ 输入'猜数'可重新开始";
         }
-        });
-
-    return rules;
+    };
+    quit.guard = [](const MessageContext& ctx) {
+        return group_target_num.count(ctx.group_id_str) > 0;
+    };
+    registry.add_exact(u8"退出", std::move(quit));
 }
\ No newline at end of file
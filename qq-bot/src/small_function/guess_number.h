@@ -2,9 +2,19 @@
 #ifndef GUESS_NUMBER_RULE_H
 #define GUESS_NUMBER_RULE_H
 
-#include "reply_generator.h"
+#include "command_registry.h"
+#include <string>
+#include <string_view>
 
-// 获取猜数游戏规则集合
-std::vector<ReplyRule> get_guess_number_rules();
+// 注册猜数游戏指令（猜数 / 数字输入 / 退出）
+void register_guess_number_commands(CommandRegistry& registry);
+
+// 猜数输入的唯一判定：规范化后的指令文本整体是一个 int 范围内的整数（可带 +/- 号，不允许其他字符）
+// 指令匹配与入口优先级共用，成功时写入 value
+bool parse_guess_input(std::string_view text, int& value);
+
+// 原始消息按指令文本的方式规范化（去不可见字符、trim、实体解码）后套用 parse_guess_input，
+// 供入口队列判断优先级，不读取游戏状态
+bool looks_like_guess_input(const std::string& raw_message);
 
 #endif // GUESS_NUMBER_RULE_H
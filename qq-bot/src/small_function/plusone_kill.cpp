@@ -10,48 +10,28 @@ struct StreakState
 };
 
 // 替换 recent_messages 的定义，类型应与头文件一致
-std::unordered_map<std::string, std::unordered_map<std::string, int>>
+thread_local std::unordered_map<std::string, std::unordered_map<std::string, int>>
     PlusOneKill::recent_messages;
 
 // 替换 last_key_map 的定义，类型应与“上一次内容”相关的存储一致
-static std::unordered_map<std::string, std::string> last_key_map;
+static thread_local std::unordered_map<std::string, std::string> last_key_map;
 
-// 从 CQ:image 文本中提取 file=XXX 的值（不含逗号和右括号）
-static std::string extract_cq_image_file(const std::string& content)
-{
-    // content 形如：[CQ:image,summary=[动画表情],file=XXX.png,sub_type=1,...]
-    const std::string key = "file=";
-    auto pos = content.find(key);
-    if (pos == std::string::npos)
-    {
-        return {};
-    }
-    pos += key.size();
-    // 找到下一个逗号或 ']'
-    size_t end = content.find_first_of(",]", pos);
-    if (end == std::string::npos)
-    {
-        end = content.size();
-    }
-    return content.substr(pos, end - pos);
-}
-
-bool PlusOneKill::HandleMessage(const std::string& group_id,
-    const std::string& /*user_id*/,
-    const std::string& content,
-    const json& /*msg_data*/,
-    json& reply)
+bool PlusOneKill::HandleMessage(const MessageContext& ctx, ReplyFrame& reply)
 {
+    const std::string& group_id = ctx.group_id_str;
+    const std::string_view content = ctx.raw_message;
     std::string key;
 
-    if (content.compare(0, 9, "[CQ:image") == 0)
+    // 以图片开头的消息按图片文件名计数（同一表情包的 url 等参数每次可能不同）
+    if (!ctx.segments.empty() && ctx.segments.front().type == CqType::Image)
     {
-        std::string file_key = extract_cq_image_file(content);
+        std::string_view file_key = ctx.segments.front().value;
         if (file_key.empty())
         {
             return false;
         }
-        key = "img:" + file_key;
+        key.reserve(4 + file_key.size());
+        key.append("img:").append(file_key);
     }
     else
     {
@@ -59,7 +39,8 @@ bool PlusOneKill::HandleMessage(const std::string& group_id,
         {
             return false;
         }
-        key = "txt:" + content;
+        key.reserve(4 + content.size());
+        key.append("txt:").append(content);
     }
 
     // 仅在同一个群内统计，不同群互不影响
@@ -87,21 +68,10 @@ bool PlusOneKill::HandleMessage(const std::string& group_id,
     return false;
 }
 
-void PlusOneKill::BuildReplyMessage(const std::string& group_id, json& reply)
+void PlusOneKill::BuildReplyMessage(const std::string& group_id, ReplyFrame& reply)
 {
     // 使用绝对路径测试（确认 OneBot 实现支持绝对路径；否则按实现文档调整）
-    std::string image_path = R"(D:\github\qq-bot\qq-bot\plusone_kill.png)";
-
-    reply = json{
-        {"action", "send_group_msg"},
-        {"params", json{
-            {"group_id", group_id},
-            {"message", json::array({
-                json{
-                    {"type", "image"},
-                    {"data", json{{"file", image_path}}}
-                }
-            })}
-        }}
-    };
+    // 以 CQ 码字符串发送，与文字回复共用同一种帧格式（路径中不含需要 CQ 转义的 & [ ] ,）
+    static const std::string image_cq = R"([CQ:image,file=D:\github\qq-bot\qq-bot\plusone_kill.png])";
+    reply.assign(group_id, image_cq);
 }
\ No newline at end of file
@@ -4,25 +4,21 @@
 #include <string>
 #include <unordered_map>
 #include <vector>
-#include <nlohmann/json.hpp>
-
-using json = nlohmann::json;
+#include "message_context.h"
+#include "reply_frame.h"
 
 class PlusOneKill {
 public:
     // 外部调用入口：处理每条群消息，返回是否需要回复
-    static bool HandleMessage(const std::string& group_id,
-        const std::string& user_id,
-        const std::string& content,
-        const json& msg_data,
-        json& reply);
+    // 以原始消息（含 CQ 码）判断是否连续重复
+    static bool HandleMessage(const MessageContext& ctx, ReplyFrame& reply);
 
 private:
     // 构造回复消息（发送本地图片）
-    static void BuildReplyMessage(const std::string& group_id, json& reply);
+    static void BuildReplyMessage(const std::string& group_id, ReplyFrame& reply);
 
-    // 按群 + 消息内容统计出现次数
-    static std::unordered_map<std::string,
+    // 按群 + 消息内容统计出现次数（线程本地：同一个群的消息总在同一分片线程上处理）
+    static thread_local std::unordered_map<std::string,
         std::unordered_map<std::string, int>> recent_messages;
 };
 
@@ -0,0 +1,115 @@
+﻿#include "alloc_counter.h"
+
+#ifndef QQBOT_ALLOC_COUNTER
+
+unsigned long long alloc_count_this_thread()
+{
+    return 0;
+}
+
+#else
+
+#include <cstdlib>
+#include <new>
+#if defined(_MSC_VER)
+#include <malloc.h>
+#endif
+
+// 线程局部计数，无需原子操作
+static thread_local unsigned long long t_alloc_count = 0;
+
+unsigned long long alloc_count_this_thread()
+{
+    return t_alloc_count;
+}
+
+namespace {
+
+// 与标准要求一致：分配失败时循环调用 new_handler，没有 handler 才抛 bad_alloc
+void* allocate(std::size_t size)
+{
+    ++t_alloc_count;
+    if (size == 0) size = 1;
+    for (;;) {
+        if (void* p = std::malloc(size)) return p;
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void* try_allocate_aligned(std::size_t size, std::size_t align)
+{
+#if defined(_MSC_VER)
+    return _aligned_malloc(size, align);
+#else
+    void* p = nullptr;
+    return posix_memalign(&p, align < sizeof(void*) ? sizeof(void*) : align, size) == 0 ? p : nullptr;
+#endif
+}
+
+void* allocate_aligned(std::size_t size, std::align_val_t align)
+{
+    ++t_alloc_count;
+    if (size == 0) size = 1;
+    for (;;) {
+        if (void* p = try_allocate_aligned(size, static_cast<std::size_t>(align))) return p;
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) throw std::bad_alloc();
+        handler();
+    }
+}
+
+// 对齐分配须用配对的释放函数（MSVC 的 _aligned_malloc 不能交给 free）
+void free_aligned(void* p)
+{
+#if defined(_MSC_VER)
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+} // namespace
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    try { return allocate(size); } catch (...) { return nullptr; }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    try { return allocate(size); } catch (...) { return nullptr; }
+}
+
+void* operator new(std::size_t size, std::align_val_t align) { return allocate_aligned(size, align); }
+void* operator new[](std::size_t size, std::align_val_t align) { return allocate_aligned(size, align); }
+
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept
+{
+    try { return allocate_aligned(size, align); } catch (...) { return nullptr; }
+}
+
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept
+{
+    try { return allocate_aligned(size, align); } catch (...) { return nullptr; }
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+void operator delete(void* p, std::align_val_t) noexcept { free_aligned(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { free_aligned(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { free_aligned(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { free_aligned(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { free_aligned(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { free_aligned(p); }
+
+#endif // QQBOT_ALLOC_COUNTER
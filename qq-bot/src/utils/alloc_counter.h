@@ -0,0 +1,17 @@
+﻿#pragma once
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+// 诊断用的堆分配计数：仅在定义 QQBOT_ALLOC_COUNTER 的构建中生效（在项目的预处理器定义中加入）
+// 生效时 alloc_counter.cpp 替换全部可替换的全局 operator new / delete（含数组、nothrow、对齐版本）并按线程计数；
+// 默认构建不替换任何分配函数，alloc_count_this_thread() 恒为 0
+#ifdef QQBOT_ALLOC_COUNTER
+constexpr bool ALLOC_COUNTER_ENABLED = true;
+#else
+constexpr bool ALLOC_COUNTER_ENABLED = false;
+#endif
+
+// 当前线程累计的堆分配次数，在一段代码前后各取一次做差，即为该段代码的分配次数
+unsigned long long alloc_count_this_thread();
+
+#endif // ALLOC_COUNTER_H
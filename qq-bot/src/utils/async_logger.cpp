@@ -0,0 +1,367 @@
+﻿#include "async_logger.h"
+#include "config.h"
+#include "utils.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+using system_clock = std::chrono::system_clock;
+
+// 一行日志占用 1~LOG_MAX_RECORD_SLOTS 个连续槽位，头部字段只在第一个槽位有效
+struct LogRecord {
+    long long time_us = 0;       // system_clock 微秒
+    std::uint32_t full_len = 0;  // 原始文本长度（超出 LOG_MAX_RECORD_SLOTS 个槽位的部分被截断）
+    std::uint16_t len = 0;       // 本槽位中的文本字节数
+    std::uint8_t slots = 1;      // 本行占用的槽位数
+    LogLevel level = LogLevel::Info;
+    char text[LOG_RECORD_TEXT_BYTES];
+};
+
+// 有界无锁队列（多生产者 / 单消费者）：每个槽位带序号，生产者以 CAS 一次抢占本行所需的连续位置
+struct alignas(64) Slot {
+    std::atomic<std::size_t> seq{ 0 };
+    LogRecord rec;
+};
+
+const char* const kLevelTags[] = { "[DEBUG] ", "", "[WARN] ", "[ERROR] " };
+
+std::atomic<bool> g_console{ true }; // 是否同时输出到控制台
+
+// 截断到 max 字节以内，且不切断 UTF-8 多字节字符
+std::size_t utf8_cut(std::string_view s, std::size_t max) {
+    if (s.size() <= max) return s.size();
+    std::size_t n = max;
+    while (n > 0 && (static_cast<unsigned char>(s[n]) & 0xC0) == 0x80) --n;
+    return n;
+}
+
+class AsyncLogger {
+public:
+    AsyncLogger()
+        : capacity_(static_cast<std::size_t>(LOG_RING_CAPACITY))
+        , mask_(capacity_ - 1)
+        , slots_(new Slot[capacity_])
+    {
+        static_assert((LOG_RING_CAPACITY & (LOG_RING_CAPACITY - 1)) == 0, "LOG_RING_CAPACITY must be a power of two");
+        static_assert(LOG_MAX_RECORD_SLOTS >= 1 && LOG_MAX_RECORD_SLOTS <= 255 && LOG_MAX_RECORD_SLOTS <= LOG_RING_CAPACITY,
+            "LOG_MAX_RECORD_SLOTS out of range");
+        for (std::size_t i = 0; i < capacity_; ++i) slots_[i].seq.store(i, std::memory_order_relaxed);
+        open_file();
+        writer_ = std::thread([this]() { run(); });
+    }
+
+    // 生产者：不加锁，缓冲满时返回 false
+    bool push(LogLevel level, std::string_view content) {
+        const std::size_t kText = static_cast<std::size_t>(LOG_RECORD_TEXT_BYTES);
+        const std::size_t kept = utf8_cut(content, kText * static_cast<std::size_t>(LOG_MAX_RECORD_SLOTS));
+        const std::size_t count = kept == 0 ? 1 : (kept + kText - 1) / kText;
+
+        // 消费者按顺序释放槽位，因此本行最后一个槽位空闲即说明前面的都空闲
+        std::size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            const std::size_t last = pos + count - 1;
+            const std::size_t seq = slots_[last & mask_].seq.load(std::memory_order_acquire);
+            const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(last);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        LogRecord& head = slots_[pos & mask_].rec;
+        head.time_us = std::chrono::duration_cast<std::chrono::microseconds>(system_clock::now().time_since_epoch()).count();
+        head.level = level;
+        head.full_len = static_cast<std::uint32_t>(std::min<std::size_t>(content.size(), UINT32_MAX));
+        head.slots = static_cast<std::uint8_t>(count);
+        // 按顺序发布各槽位：消费者看到最后一个已发布时，前面的内容都已可见
+        for (std::size_t i = 0; i < count; ++i) {
+            Slot& slot = slots_[(pos + i) & mask_];
+            const std::size_t offset = i * kText;
+            slot.rec.len = static_cast<std::uint16_t>(std::min(kText, kept - offset));
+            std::memcpy(slot.rec.text, content.data() + offset, slot.rec.len);
+            slot.seq.store(pos + i + 1, std::memory_order_release);
+        }
+
+        // 积压超过一半时提前唤醒后台线程（不持锁通知，偶尔错过也只是等到下一次轮询）
+        if (pos + count - consumed_pos_.load(std::memory_order_relaxed) >= capacity_ / 2
+            && !wake_pending_.exchange(true, std::memory_order_relaxed)) {
+            cv_.notify_one();
+        }
+        return true;
+    }
+
+    // 等待后台线程写完当前已入队的记录
+    void flush() {
+        const std::size_t target = enqueue_pos_.load(std::memory_order_acquire);
+        std::unique_lock<std::mutex> lock(mtx_);
+        flush_requested_ = true;
+        cv_.notify_one();
+        done_cv_.wait(lock, [&]() { return written_pos_ >= target || stopped_; });
+    }
+
+    // 进程退出：写完剩余记录后停止后台线程，之后的日志直接同步写出
+    void shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (stop_) return;
+            stop_ = true;
+        }
+        cv_.notify_one();
+        if (writer_.joinable()) writer_.join();
+        if (file_ != nullptr) {
+            std::fclose(file_);
+            file_ = nullptr;
+        }
+    }
+
+    bool stopped() const { return stopped_flag_.load(std::memory_order_acquire); }
+
+    std::string stats() const {
+        return "log written=" + std::to_string(written_.load(std::memory_order_relaxed))
+            + " dropped=" + std::to_string(dropped_.load(std::memory_order_relaxed))
+            + " truncated=" + std::to_string(truncated_.load(std::memory_order_relaxed));
+    }
+
+private:
+    void run() {
+        std::string console;
+        std::string file_gbk;
+        unsigned long long reported_drops = 0;
+        for (;;) {
+            console.clear();
+            wake_pending_.store(false, std::memory_order_relaxed);
+            std::size_t n = 0; // 本轮取出的槽位数
+            while (n < capacity_) {
+                const std::size_t used = pop_format(console);
+                if (used == 0) break;
+                n += used;
+            }
+
+            // 有新的丢弃时补一行说明，便于从日志本身看出缺失
+            const unsigned long long drops = dropped_.load(std::memory_order_relaxed);
+            if (drops != reported_drops) {
+                format_line(console, system_clock::now(), LogLevel::Warn,
+                    "Log ring full, dropped " + std::to_string(drops - reported_drops) + " records");
+                reported_drops = drops;
+            }
+
+            if (!console.empty()) {
+                if (g_console.load(std::memory_order_relaxed)) {
+                    std::fwrite(console.data(), 1, console.size(), stdout);
+                    std::fflush(stdout);
+                }
+                // 文件写入仍转GBK（兼容Windows记事本）
+                utf8_to_gbk(console.data(), console.size(), file_gbk);
+                write_file(file_gbk);
+            }
+
+            std::unique_lock<std::mutex> lock(mtx_);
+            written_pos_ += n;
+            done_cv_.notify_all();
+            if (n >= capacity_) continue; // 缓冲可能仍有积压，立即再取
+            if (stop_) {
+                if (has_pending()) continue;
+                stopped_ = true;
+                stopped_flag_.store(true, std::memory_order_release);
+                done_cv_.notify_all();
+                return;
+            }
+            if (flush_requested_ && has_pending()) continue;
+            flush_requested_ = false;
+            cv_.wait_for(lock, std::chrono::milliseconds(LOG_FLUSH_INTERVAL_MS));
+        }
+    }
+
+    // 下一行是否已完整发布（首尾槽位都已写好）
+    bool has_pending() const {
+        const Slot& first = slots_[dequeue_pos_ & mask_];
+        if (first.seq.load(std::memory_order_acquire) != dequeue_pos_ + 1) return false;
+        const std::size_t last = dequeue_pos_ + first.rec.slots - 1;
+        return slots_[last & mask_].seq.load(std::memory_order_acquire) == last + 1;
+    }
+
+    // 消费者：取出一行并格式化追加到 out，没有已完整发布的行时返回 false；返回占用的槽位数
+    std::size_t pop_format(std::string& out) {
+        if (!has_pending()) return 0;
+        const LogRecord& head = slots_[dequeue_pos_ & mask_].rec;
+        const std::size_t count = head.slots;
+        line_.clear();
+        for (std::size_t i = 0; i < count; ++i) {
+            const LogRecord& rec = slots_[(dequeue_pos_ + i) & mask_].rec;
+            line_.append(rec.text, rec.len);
+        }
+        const system_clock::time_point at{ std::chrono::duration_cast<system_clock::duration>(std::chrono::microseconds(head.time_us)) };
+        format_line(out, at, head.level, line_);
+        if (head.full_len > line_.size()) {
+            out.pop_back();
+            out += " ...(" + std::to_string(head.full_len) + " bytes)\n";
+            truncated_.fetch_add(1, std::memory_order_relaxed);
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            slots_[(dequeue_pos_ + i) & mask_].seq.store(dequeue_pos_ + i + capacity_, std::memory_order_release);
+        }
+        dequeue_pos_ += count;
+        consumed_pos_.store(dequeue_pos_, std::memory_order_relaxed);
+        written_.fetch_add(1, std::memory_order_relaxed);
+        return count;
+    }
+
+    // "[YYYY-mm-dd HH:MM:SS] [级别] 文本\n"，时间前缀按秒缓存
+    void format_line(std::string& out, system_clock::time_point at, LogLevel level, std::string_view text) {
+        const std::time_t sec = system_clock::to_time_t(at);
+        if (sec != cached_sec_) {
+            std::tm tm_now;
+#if defined(_MSC_VER)
+            localtime_s(&tm_now, &sec);
+#else
+            localtime_r(&sec, &tm_now);
+#endif
+            cached_len_ = std::strftime(cached_prefix_, sizeof(cached_prefix_), "[%Y-%m-%d %H:%M:%S] ", &tm_now);
+            cached_sec_ = sec;
+        }
+        out.append(cached_prefix_, cached_len_);
+        out.append(kLevelTags[static_cast<int>(level)]);
+        out.append(text.data(), text.size());
+        out.push_back('\n');
+    }
+
+    void open_file() {
+        file_ = std::fopen(LOG_FILE, "ab");
+        if (file_ == nullptr) return;
+        std::fseek(file_, 0, SEEK_END);
+        const long size = std::ftell(file_);
+        file_bytes_ = size < 0 ? 0 : size;
+    }
+
+    // 超过 LOG_MAX_FILE_BYTES 时轮转：robot_log.txt -> .1 -> .2 ...，最旧的删除
+    void rotate() {
+        if (file_ != nullptr) std::fclose(file_);
+        file_ = nullptr;
+        const std::string base = LOG_FILE;
+        std::remove((base + "." + std::to_string(LOG_MAX_FILES)).c_str());
+        for (int i = LOG_MAX_FILES - 1; i >= 1; --i) {
+            std::rename((base + "." + std::to_string(i)).c_str(), (base + "." + std::to_string(i + 1)).c_str());
+        }
+        if (LOG_MAX_FILES > 0) std::rename(base.c_str(), (base + ".1").c_str());
+        else std::remove(base.c_str());
+        open_file();
+    }
+
+    void write_file(const std::string& data) {
+        if (file_bytes_ > 0 && file_bytes_ + static_cast<long long>(data.size()) > LOG_MAX_FILE_BYTES) rotate();
+        if (file_ == nullptr) return;
+        std::fwrite(data.data(), 1, data.size(), file_);
+        std::fflush(file_);
+        file_bytes_ += static_cast<long long>(data.size());
+    }
+
+    const std::size_t capacity_;
+    const std::size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+    alignas(64) std::atomic<std::size_t> enqueue_pos_{ 0 };
+    alignas(64) std::size_t dequeue_pos_ = 0; // 仅后台线程访问
+    std::string line_;                        // 跨槽位拼接的一行，仅后台线程访问
+    alignas(64) std::atomic<std::size_t> consumed_pos_{ 0 }; // dequeue_pos_ 的副本，供生产者估算积压
+    std::atomic<bool> wake_pending_{ false };
+
+    std::atomic<unsigned long long> written_{ 0 };
+    std::atomic<unsigned long long> dropped_{ 0 };
+    std::atomic<unsigned long long> truncated_{ 0 };
+
+    // 以下仅用于唤醒 / 等待后台线程，生产者不触碰
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::condition_variable done_cv_;
+    std::size_t written_pos_ = 0;
+    bool flush_requested_ = false;
+    bool stop_ = false;
+    bool stopped_ = false;
+    std::atomic<bool> stopped_flag_{ false };
+    std::thread writer_;
+
+    // 仅后台线程访问
+    std::FILE* file_ = nullptr;
+    long long file_bytes_ = 0;
+    std::time_t cached_sec_ = -1;
+    char cached_prefix_[32] = {};
+    std::size_t cached_len_ = 0;
+};
+
+// 惰性单例：首次写日志时创建（可能早于 main，如静态初始化中的日志），有意不析构，
+// 由 atexit 写完剩余记录，避免其他静态对象析构时写日志访问到已销毁的实例
+AsyncLogger& logger() {
+    static AsyncLogger* instance = []() {
+        AsyncLogger* l = new AsyncLogger();
+        std::atexit([]() { logger().shutdown(); });
+        return l;
+    }();
+    return *instance;
+}
+
+std::atomic<unsigned long long> g_sample_counters[static_cast<std::size_t>(LogCategory::Count)] = {};
+
+int sample_every(LogCategory category) {
+    switch (category) {
+    case LogCategory::Received: return LOG_SAMPLE_RECEIVED_EVERY;
+    default: return 1;
+    }
+}
+
+} // namespace
+
+void write_log(LogLevel level, std::string_view content)
+{
+    if (!log_enabled(level)) return;
+    AsyncLogger& l = logger();
+    if (l.stopped()) {
+        // 退出阶段后台线程已停止：直接写到控制台
+        std::fwrite(content.data(), 1, content.size(), stdout);
+        std::fputc('\n', stdout);
+        return;
+    }
+    l.push(level, content);
+}
+
+bool log_enabled(LogLevel level)
+{
+    return static_cast<int>(level) >= LOG_MIN_LEVEL;
+}
+
+bool log_sampled(LogCategory category)
+{
+    const int every = sample_every(category);
+    if (every <= 1) return true;
+    return g_sample_counters[static_cast<std::size_t>(category)].fetch_add(1, std::memory_order_relaxed)
+        % static_cast<unsigned long long>(every) == 0;
+}
+
+void log_flush()
+{
+    logger().flush();
+}
+
+void log_set_console(bool enabled)
+{
+    g_console.store(enabled, std::memory_order_relaxed);
+}
+
+std::string log_stats()
+{
+    return logger().stats();
+}
@@ -0,0 +1,41 @@
+﻿#pragma once
+#ifndef ASYNC_LOGGER_H
+#define ASYNC_LOGGER_H
+
+#include <string>
+#include <string_view>
+
+// 异步日志：调用线程只取时间戳并把文本拷入无锁环形缓冲的定长槽位（较长的一行占多个连续槽位；不加锁、不做 IO）
+// 后台线程批量取出记录，格式化时间、转 GBK 后写入日志文件（按大小轮转）并输出到控制台
+// 缓冲写满时新记录直接丢弃并计数，不阻塞业务线程；首次写日志时启动后台线程，进程退出时写完剩余记录
+enum class LogLevel {
+    Debug = 0,
+    Info = 1,
+    Warn = 2,
+    Error = 3
+};
+
+// 需要采样的高频日志类别（采样间隔见 config.h）
+enum class LogCategory {
+    Received = 0, // 每条群消息的 "Received message ..." 行
+    Count
+};
+
+void write_log(LogLevel level, std::string_view content);
+
+// 该级别是否会被记录：拼接较重的日志先判断再构造文本
+bool log_enabled(LogLevel level);
+
+// 本条是否应记录（按类别每 N 条取 1 条）
+bool log_sampled(LogCategory category);
+
+// 等待后台线程写完调用前已入队的记录
+void log_flush();
+
+// 是否同时输出到控制台（默认输出；回放等工具关闭以免淹没结果），日志文件不受影响
+void log_set_console(bool enabled);
+
+// 统计摘要：已写出 / 丢弃 / 截断的记录数
+std::string log_stats();
+
+#endif // ASYNC_LOGGER_H
@@ -0,0 +1,98 @@
+﻿#include "cq_code.h"
+
+namespace {
+
+// 每种段类型的主参数名
+std::string_view main_param(CqType type)
+{
+    switch (type) {
+    case CqType::At: return "qq";
+    case CqType::Image: return "file";
+    case CqType::Reply:
+    case CqType::Face: return "id";
+    default: return {};
+    }
+}
+
+void push_text(std::string_view text, std::vector<CqSegment>& out)
+{
+    if (text.empty()) return;
+    CqSegment seg;
+    seg.type = CqType::Text;
+    seg.name = "text";
+    seg.value = text;
+    seg.raw = text;
+    seg.escaped = true;
+    out.push_back(seg);
+}
+
+} // namespace
+
+CqType cq_type_from_name(std::string_view name)
+{
+    if (name == "text") return CqType::Text;
+    if (name == "at") return CqType::At;
+    if (name == "image") return CqType::Image;
+    if (name == "reply") return CqType::Reply;
+    if (name == "face") return CqType::Face;
+    return CqType::Other;
+}
+
+std::string_view cq_param(std::string_view params, std::string_view key)
+{
+    size_t pos = 0;
+    while (pos <= params.size()) {
+        size_t end = params.find(',', pos);
+        if (end == std::string_view::npos) end = params.size();
+        std::string_view kv = params.substr(pos, end - pos);
+        if (kv.size() > key.size() && kv[key.size()] == '=' && kv.compare(0, key.size(), key) == 0) {
+            return kv.substr(key.size() + 1);
+        }
+        pos = end + 1;
+    }
+    return {};
+}
+
+void cq_tokenize(std::string_view raw, std::vector<CqSegment>& out)
+{
+    out.clear();
+    size_t text_begin = 0;
+    size_t pos = 0;
+    // CQ 码参数中的 ']' 与 ',' 均已转义，因此第一个 ']' 即为该 CQ 码的结尾
+    while ((pos = raw.find("[CQ:", pos)) != std::string_view::npos) {
+        const size_t close = raw.find(']', pos + 4);
+        if (close == std::string_view::npos) break;
+
+        push_text(raw.substr(text_begin, pos - text_begin), out);
+
+        std::string_view body = raw.substr(pos + 4, close - pos - 4); // type,k=v,...
+        const size_t comma = body.find(',');
+        CqSegment seg;
+        seg.name = body.substr(0, comma);
+        seg.type = cq_type_from_name(seg.name);
+        if (seg.type == CqType::Text) seg.type = CqType::Other; // [CQ:text] 不是合法 CQ 码
+        if (comma != std::string_view::npos) {
+            const std::string_view key = main_param(seg.type);
+            if (!key.empty()) seg.value = cq_param(body.substr(comma + 1), key);
+        }
+        seg.raw = raw.substr(pos, close + 1 - pos);
+        seg.escaped = true;
+        out.push_back(seg);
+
+        pos = text_begin = close + 1;
+    }
+    push_text(raw.substr(text_begin), out);
+}
+
+void cq_segments_from_array(const std::vector<CqArraySegment>& segments, std::vector<CqSegment>& out)
+{
+    out.clear();
+    out.reserve(segments.size());
+    for (const auto& s : segments) {
+        CqSegment seg;
+        seg.name = s.type;
+        seg.type = cq_type_from_name(s.type);
+        seg.value = s.value;
+        out.push_back(seg);
+    }
+}
@@ -0,0 +1,46 @@
+﻿#pragma once
+#ifndef CQ_CODE_H
+#define CQ_CODE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// OneBot 消息段：字符串格式（raw_message 中的 CQ 码）与数组格式（message 数组）统一成同一种段视图
+enum class CqType {
+    Text,
+    At,
+    Image,
+    Reply,
+    Face,
+    Other
+};
+
+struct CqSegment {
+    CqType type = CqType::Text;
+    std::string_view name;   // 段类型名：text / at / image / reply / face / 其他 CQ 码类型名
+    std::string_view value;  // 主参数：Text 为文本，At 为 qq，Image 为 file，Reply / Face 为 id，Other 为空
+    std::string_view raw;    // 字符串格式下该段在原消息中的原文（CQ 码含方括号）；数组格式为空
+    bool escaped = false;    // value 是否仍为 CQ 转义形式（&amp; &#91; &#93; &#44;），字符串格式为 true
+};
+
+// 数组格式中的一段：解码时只保留类型与主参数（见 CqSegment::value），段视图指向这里的数据
+struct CqArraySegment {
+    std::string type;
+    std::string value;
+};
+
+// 段类型名 -> 类型
+CqType cq_type_from_name(std::string_view name);
+
+// 单趟切分字符串格式消息，不拷贝：段视图指向 raw，须在 raw 有效期内使用
+// out 先清空再追加（复用容量）；未闭合的 "[CQ:" 按普通文本处理
+void cq_tokenize(std::string_view raw, std::vector<CqSegment>& out);
+
+// 由数组格式的段生成段视图（指向 segments 中的字符串，须在其有效期内使用）
+void cq_segments_from_array(const std::vector<CqArraySegment>& segments, std::vector<CqSegment>& out);
+
+// 取 CQ 码参数值：params 形如 "qq=123,name=abc"，找不到返回空
+std::string_view cq_param(std::string_view params, std::string_view key);
+
+#endif // CQ_CODE_H
@@ -0,0 +1,175 @@
+﻿#include "gbk_codec.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+#include "gbk_table.inc"
+
+constexpr unsigned kLeadFirst = 0x81;
+constexpr unsigned kLeadLast = 0xFE;
+constexpr unsigned kTrailFirst = 0x40;
+constexpr unsigned kTrailLast = 0xFE;
+constexpr unsigned kTrailCount = kTrailLast - kTrailFirst + 1;
+
+// CP936 单字节 0x80 为欧元符号（Python 的 gbk 编解码器没有这一项，单独处理）
+constexpr uint32_t kEuro = 0x20AC;
+constexpr unsigned char kEuroByte = 0x80;
+constexpr uint32_t kReplacement = 0xFFFD;
+
+// 从 p 开始连续 ASCII 的字节数（每次看 8 字节），最多 limit
+inline size_t ascii_run(const unsigned char* p, size_t limit) {
+    size_t i = 0;
+    while (i + 8 <= limit) {
+        uint64_t w;
+        std::memcpy(&w, p + i, sizeof(w));
+        if (w & 0x8080808080808080ULL) break;
+        i += 8;
+    }
+    while (i < limit && p[i] < 0x80) ++i;
+    return i;
+}
+
+inline size_t utf8_len_of(uint32_t cp) {
+    return cp < 0x80 ? 1 : cp < 0x800 ? 2 : 3; // 表内码点都在 BMP
+}
+
+inline void put_utf8(uint32_t cp, unsigned char* out) {
+    if (cp < 0x80) {
+        out[0] = static_cast<unsigned char>(cp);
+    } else if (cp < 0x800) {
+        out[0] = static_cast<unsigned char>(0xC0 | (cp >> 6));
+        out[1] = static_cast<unsigned char>(0x80 | (cp & 0x3F));
+    } else {
+        out[0] = static_cast<unsigned char>(0xE0 | (cp >> 12));
+        out[1] = static_cast<unsigned char>(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = static_cast<unsigned char>(0x80 | (cp & 0x3F));
+    }
+}
+
+// Unicode(BMP) -> GBK 双字节（高字节在前），0 表示无对应
+// 有意不析构：进程退出时日志后台线程（atexit 中停止）仍可能在转码
+const std::vector<uint16_t>& unicode_to_gbk_table() {
+    static const std::vector<uint16_t>* table = [] {
+        auto* t = new std::vector<uint16_t>(0x10000, 0);
+        for (unsigned lead = kLeadFirst; lead <= kLeadLast; ++lead) {
+            for (unsigned trail = kTrailFirst; trail <= kTrailLast; ++trail) {
+                const uint16_t cp = kGbkToUnicode[(lead - kLeadFirst) * kTrailCount + (trail - kTrailFirst)];
+                if (cp != 0 && (*t)[cp] == 0) (*t)[cp] = static_cast<uint16_t>((lead << 8) | trail);
+            }
+        }
+        return t;
+    }();
+    return *table;
+}
+
+// 解一个 UTF-8 多字节字符；返回长度，0 表示非法，-1 表示输入在字符中间截断
+int decode_utf8(const unsigned char* p, size_t avail, uint32_t& cp) {
+    const unsigned char c = p[0];
+    int len;
+    uint32_t min;
+    if (c >= 0xC2 && c <= 0xDF) { len = 2; cp = c & 0x1F; min = 0x80; }
+    else if (c >= 0xE0 && c <= 0xEF) { len = 3; cp = c & 0x0F; min = 0x800; }
+    else if (c >= 0xF0 && c <= 0xF4) { len = 4; cp = c & 0x07; min = 0x10000; }
+    else return 0;
+    for (int k = 1; k < len; ++k) {
+        if (static_cast<size_t>(k) >= avail) return -1;
+        if ((p[k] & 0xC0) != 0x80) return 0;
+        cp = (cp << 6) | (p[k] & 0x3F);
+    }
+    if (cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) return 0;
+    return len;
+}
+
+} // namespace
+
+TranscodeResult gbk_to_utf8_into(const char* src, size_t src_len, char* dst, size_t dst_cap, bool last_chunk)
+{
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(src);
+    unsigned char* out = reinterpret_cast<unsigned char*>(dst);
+    TranscodeResult r;
+    size_t i = 0, o = 0;
+    while (i < src_len) {
+        const size_t run = ascii_run(in + i, (src_len - i < dst_cap - o) ? src_len - i : dst_cap - o);
+        if (run > 0) {
+            std::memcpy(out + o, in + i, run);
+            i += run;
+            o += run;
+            continue;
+        }
+        if (o == dst_cap) break;
+
+        const unsigned char c = in[i];
+        uint32_t cp = kReplacement;
+        size_t used = 1;
+        if (c == kEuroByte) {
+            cp = kEuro;
+        } else if (c >= kLeadFirst && c <= kLeadLast) {
+            if (i + 1 >= src_len) {
+                if (!last_chunk) break; // 等待下一段补齐尾字节
+            } else {
+                const unsigned char t = in[i + 1];
+                if (t >= kTrailFirst && t <= kTrailLast && t != 0x7F) {
+                    const uint16_t mapped = kGbkToUnicode[(c - kLeadFirst) * kTrailCount + (t - kTrailFirst)];
+                    if (mapped != 0) cp = mapped;
+                    used = 2;
+                }
+                // 尾字节不合法（如 ASCII）时只吞掉首字节，尾字节按原样继续处理
+            }
+        }
+        const size_t need = utf8_len_of(cp);
+        if (dst_cap - o < need) break;
+        if (cp == kReplacement) ++r.replaced;
+        put_utf8(cp, out + o);
+        o += need;
+        i += used;
+    }
+    r.read = i;
+    r.written = o;
+    return r;
+}
+
+TranscodeResult utf8_to_gbk_into(const char* src, size_t src_len, char* dst, size_t dst_cap, bool last_chunk)
+{
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(src);
+    unsigned char* out = reinterpret_cast<unsigned char*>(dst);
+    const std::vector<uint16_t>& reverse = unicode_to_gbk_table();
+    TranscodeResult r;
+    size_t i = 0, o = 0;
+    while (i < src_len) {
+        const size_t run = ascii_run(in + i, (src_len - i < dst_cap - o) ? src_len - i : dst_cap - o);
+        if (run > 0) {
+            std::memcpy(out + o, in + i, run);
+            i += run;
+            o += run;
+            continue;
+        }
+        if (o == dst_cap) break;
+
+        uint32_t cp = 0;
+        const int len = decode_utf8(in + i, src_len - i, cp);
+        if (len < 0 && !last_chunk) break; // 字符被截断，等待下一段
+        uint16_t gbk = 0;
+        if (len > 0) {
+            if (cp == kEuro) gbk = kEuroByte;
+            else if (cp <= 0xFFFF) gbk = reverse[cp];
+        }
+        const size_t need = gbk > 0xFF ? 2 : 1;
+        if (dst_cap - o < need) break;
+        if (gbk == 0) {
+            out[o] = '?';
+            ++r.replaced;
+        } else if (need == 2) {
+            out[o] = static_cast<unsigned char>(gbk >> 8);
+            out[o + 1] = static_cast<unsigned char>(gbk & 0xFF);
+        } else {
+            out[o] = static_cast<unsigned char>(gbk);
+        }
+        o += need;
+        i += len > 0 ? static_cast<size_t>(len) : 1;
+    }
+    r.read = i;
+    r.written = o;
+    return r;
+}
@@ -0,0 +1,27 @@
+﻿#pragma once
+#ifndef GBK_CODEC_H
+#define GBK_CODEC_H
+
+#include <cstddef>
+
+// 查表实现的 GBK(CP936) <-> UTF-8 直接转换，不经 UTF-16 中间态，不分配内存
+// 输出写入调用方提供的缓冲区；可分段调用（流式），按返回的 read 继续处理剩余输入
+struct TranscodeResult {
+    size_t read = 0;      // 已消费的输入字节数
+    size_t written = 0;   // 已写入的输出字节数
+    size_t replaced = 0;  // 非法 / 无法映射而输出替换字符的次数
+};
+
+// 输出缓冲足以容纳全部结果的大小
+constexpr size_t gbk_to_utf8_max_len(size_t gbk_len) { return gbk_len * 3; }
+constexpr size_t utf8_to_gbk_max_len(size_t utf8_len) { return utf8_len; }
+
+// GBK -> UTF-8：非法或未定义的序列输出 U+FFFD
+// dst 空间不足时停在字符边界返回；last_chunk=false 时末尾不完整的双字节留待下一段
+TranscodeResult gbk_to_utf8_into(const char* src, size_t src_len, char* dst, size_t dst_cap, bool last_chunk = true);
+
+// UTF-8 -> GBK：非法 UTF-8 或 GBK 中不存在的字符输出 '?'
+// 反向表在首次调用时由正向表生成
+TranscodeResult utf8_to_gbk_into(const char* src, size_t src_len, char* dst, size_t dst_cap, bool last_chunk = true);
+
+#endif // GBK_CODEC_H
@@ -0,0 +1,95 @@
+﻿#pragma once
+#ifndef STATS_H
+#define STATS_H
+
+#include <atomic>
+#include <string>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// 简单采样统计：次数 / 平均 / 最大，多线程可并发 add
+struct SampleStat {
+    std::atomic<unsigned long long> count{ 0 };
+    std::atomic<unsigned long long> total{ 0 };
+    std::atomic<unsigned long long> max{ 0 };
+
+    void add(long long value) {
+        const unsigned long long v = value < 0 ? 0 : static_cast<unsigned long long>(value);
+        count.fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(v, std::memory_order_relaxed);
+        unsigned long long prev = max.load(std::memory_order_relaxed);
+        while (v > prev && !max.compare_exchange_weak(prev, v, std::memory_order_relaxed)) {
+        }
+    }
+
+    std::string summary(const char* unit = "") const {
+        const unsigned long long n = count.load(std::memory_order_relaxed);
+        const unsigned long long avg = n == 0 ? 0 : total.load(std::memory_order_relaxed) / n;
+        return "n=" + std::to_string(n) + " avg=" + std::to_string(avg) + unit + " max="
+            + std::to_string(max.load(std::memory_order_relaxed)) + unit;
+    }
+};
+
+// 延迟统计（微秒）
+struct LatencyStat : SampleStat {
+    std::string summary() const { return SampleStat::summary("us"); }
+};
+
+// 对数分桶直方图（微秒）：第 0 桶为 0，第 i 桶为 [2^(i-1), 2^i)，最后一桶收纳更大的值
+// 固定 32 个桶、只增不清零，多线程可并发 add；分位数取所在桶的上界（不超过实际最大值）
+struct Log2Histogram {
+    static constexpr int kBuckets = 32;
+
+    std::atomic<unsigned long long> buckets[kBuckets] = {};
+    SampleStat samples; // 次数 / 总和 / 最大
+
+    static int bucket_of(unsigned long long v) {
+        if (v == 0) return 0;
+#if defined(_MSC_VER)
+        unsigned long index = 0;
+        _BitScanReverse64(&index, v);
+        const int bits = static_cast<int>(index) + 1;
+#else
+        const int bits = 64 - __builtin_clzll(v);
+#endif
+        return bits < kBuckets ? bits : kBuckets - 1;
+    }
+
+    void add(long long value) {
+        const unsigned long long v = value < 0 ? 0 : static_cast<unsigned long long>(value);
+        buckets[bucket_of(v)].fetch_add(1, std::memory_order_relaxed);
+        samples.add(value);
+    }
+
+    unsigned long long count() const { return samples.count.load(std::memory_order_relaxed); }
+    unsigned long long max() const { return samples.max.load(std::memory_order_relaxed); }
+
+    // p 取 0~1，如 0.5 / 0.99；无样本时返回 0
+    unsigned long long percentile(double p) const {
+        unsigned long long total = 0;
+        unsigned long long counts[kBuckets];
+        for (int i = 0; i < kBuckets; ++i) {
+            counts[i] = buckets[i].load(std::memory_order_relaxed);
+            total += counts[i];
+        }
+        if (total == 0) return 0;
+        const unsigned long long rank = static_cast<unsigned long long>(p * static_cast<double>(total - 1)) + 1;
+        unsigned long long seen = 0;
+        for (int i = 0; i < kBuckets; ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                const unsigned long long upper = i == 0 ? 0 : (1ULL << i) - 1;
+                return upper < max() ? upper : max();
+            }
+        }
+        return max();
+    }
+
+    std::string summary() const {
+        return "n=" + std::to_string(count()) + " p50=" + std::to_string(percentile(0.5)) + "us p99="
+            + std::to_string(percentile(0.99)) + "us max=" + std::to_string(max()) + "us";
+    }
+};
+
+#endif // STATS_H
@@ -0,0 +1,86 @@
+﻿#include "text_normalize.h"
+#include <cstring>
+
+namespace {
+
+bool ends_with(const std::string& s, const char* tail, size_t len) {
+    return s.size() >= len && std::memcmp(s.data() + s.size() - len, tail, len) == 0;
+}
+
+// 需要整体去除的不可见字符：U+FEFF BOM、U+200B 零宽空格、U+00A0 NBSP、U+3000 全角空格
+// 在输出尾部匹配：夹在序列中间的控制字符先被丢弃，与旧版“先去控制字符再删序列”一致
+bool pop_invisible(std::string& out) {
+    switch (static_cast<unsigned char>(out.back())) {
+    case 0xBF:
+        if (ends_with(out, "\xEF\xBB\xBF", 3)) { out.resize(out.size() - 3); return true; }
+        break;
+    case 0x8B:
+        if (ends_with(out, "\xE2\x80\x8B", 3)) { out.resize(out.size() - 3); return true; }
+        break;
+    case 0xA0:
+        if (ends_with(out, "\xC2\xA0", 2)) { out.resize(out.size() - 2); return true; }
+        break;
+    case 0x80:
+        if (ends_with(out, "\xE3\x80\x80", 3)) { out.resize(out.size() - 3); return true; }
+        break;
+    default:
+        break;
+    }
+    return false;
+}
+
+// 刚写入 ';' 时检查尾部是否构成实体；实体只在开头有 '&'、结尾有 ';'，尾部匹配即可找全
+// decoded_amp 为上一个由 "&amp;" 解出的 '&' 的位置：旧版按 [ ] " & { } 的顺序逐项替换，
+// 因此它之后只会再参与 "&#123;" / "&#125;" 的替换
+void decode_entity_tail(std::string& out, size_t& decoded_amp) {
+    struct Entity { const char* text; size_t len; char ch; bool after_amp; };
+    static const Entity entities[] = {
+        { "&#91;", 5, '[', false },
+        { "&#93;", 5, ']', false },
+        { "&quot;", 6, '"', false },
+        { "&amp;", 5, '&', false },
+        { "&#123;", 6, '{', true },
+        { "&#125;", 6, '}', true },
+    };
+    for (const auto& e : entities) {
+        if (!ends_with(out, e.text, e.len)) continue;
+        const size_t at = out.size() - e.len;
+        if (at == decoded_amp && !e.after_amp) return;
+        out.resize(at);
+        out.push_back(e.ch);
+        if (e.ch == '&') decoded_amp = at;
+        return;
+    }
+}
+
+bool is_trim_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+} // namespace
+
+void normalize_text_into(std::string_view in, std::string& out, bool decode_entities)
+{
+    out.clear();
+    out.reserve(in.size());
+    size_t decoded_amp = std::string::npos;
+    for (char ch : in) {
+        const unsigned char c = static_cast<unsigned char>(ch);
+        if (c < 32 || c == 127) continue; // 去除ASCII控制字符
+        if (out.empty() && c == ' ') continue; // 开头的空白直接跳过
+        out.push_back(ch);
+        if (c >= 0x80) {
+            pop_invisible(out);
+        } else if (c == ';' && decode_entities) {
+            decode_entity_tail(out, decoded_amp);
+        }
+    }
+
+    // 实体中不含空白、解码也不产生空白，因此先解码后 trim 与旧版先 trim 后解码等价
+    size_t end = out.size();
+    while (end > 0 && is_trim_space(out[end - 1])) --end;
+    out.resize(end);
+    size_t start = 0;
+    while (start < out.size() && is_trim_space(out[start])) ++start;
+    if (start > 0) out.erase(0, start);
+}
@@ -0,0 +1,23 @@
+﻿#pragma once
+#ifndef TEXT_NORMALIZE_H
+#define TEXT_NORMALIZE_H
+
+#include <string>
+#include <string_view>
+
+// 指令文本规范化：去除 ASCII 控制字符、BOM、零宽空格、NBSP、全角空格，两端 trim，
+// 可选解码 CQ 转义实体（&#91; &#93; &quot; &amp; &#123; &#125;）
+// 单趟线性扫描，结果写入调用方提供的缓冲区（先清空，保留容量以便复用）
+//
+// 与旧版“逐项 find/erase + 逐实体 replace”的结果逐字节一致（输入为合法 UTF-8 时；
+// 帧入口已保证），包括旧版替换顺序带来的特例：
+// "&amp;#123;" / "&amp;#125;" 会被连续解码两次得到 "{" / "}"，而 "&amp;#91;" 等只解码一次
+void normalize_text_into(std::string_view in, std::string& out, bool decode_entities = true);
+
+inline std::string normalize_text(std::string_view in, bool decode_entities = true) {
+    std::string out;
+    normalize_text_into(in, out, decode_entities);
+    return out;
+}
+
+#endif // TEXT_NORMALIZE_H
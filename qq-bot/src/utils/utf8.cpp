@@ -0,0 +1,287 @@
+﻿#include "utf8.h"
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define UTF8_USE_SSE2 1
+#endif
+
+// SSSE3 查表校验：x86 上总是编译，运行时按 CPU 支持情况选用（GCC / Clang 用 target 属性，无需全局 -mssse3）
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <tmmintrin.h>
+#define UTF8_USE_SSSE3 1
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define UTF8_SSSE3_TARGET
+#else
+#define UTF8_SSSE3_TARGET __attribute__((target("ssse3")))
+#endif
+#endif
+
+namespace {
+
+// 字节分类
+enum ByteClass : uint8_t {
+    kAscii,     // 00-7F
+    kCont80,    // 80-8F
+    kCont90,    // 90-9F
+    kContA0,    // A0-BF
+    kLead2,     // C2-DF
+    kLeadE0,    // E0
+    kLead3,     // E1-EC, EE-EF
+    kLeadED,    // ED
+    kLeadF0,    // F0
+    kLead4,     // F1-F3
+    kLeadF4,    // F4
+    kInvalid,   // C0, C1, F5-FF
+    kClassCount
+};
+
+// 状态：kAccept 表示处于字符边界
+enum State : uint8_t {
+    kAccept,
+    kReject,
+    kTail1,     // 还需 1 个任意续字节
+    kTail2,     // 还需 2 个任意续字节
+    kTail3,     // 还需 3 个任意续字节
+    kAfterE0,   // 下一字节须为 A0-BF（排除过长编码）
+    kAfterED,   // 下一字节须为 80-9F（排除代理区）
+    kAfterF0,   // 下一字节须为 90-BF（排除过长编码）
+    kAfterF4,   // 下一字节须为 80-8F（不超过 U+10FFFF）
+    kStateCount
+};
+
+constexpr std::array<uint8_t, 256> make_byte_classes() {
+    std::array<uint8_t, 256> t{};
+    for (int b = 0; b < 256; ++b) {
+        uint8_t c = kInvalid;
+        if (b <= 0x7F) c = kAscii;
+        else if (b <= 0x8F) c = kCont80;
+        else if (b <= 0x9F) c = kCont90;
+        else if (b <= 0xBF) c = kContA0;
+        else if (b >= 0xC2 && b <= 0xDF) c = kLead2;
+        else if (b == 0xE0) c = kLeadE0;
+        else if (b == 0xED) c = kLeadED;
+        else if (b >= 0xE1 && b <= 0xEF) c = kLead3;
+        else if (b == 0xF0) c = kLeadF0;
+        else if (b >= 0xF1 && b <= 0xF3) c = kLead4;
+        else if (b == 0xF4) c = kLeadF4;
+        t[static_cast<size_t>(b)] = c;
+    }
+    return t;
+}
+
+constexpr std::array<uint8_t, 256> kByteClass = make_byte_classes();
+
+#define R kReject
+constexpr uint8_t kTransition[kStateCount][kClassCount] = {
+    //           ascii     80-8F     90-9F     A0-BF     C2-DF     E0        E1-EF     ED        F0        F1-F3     F4        invalid
+    /* Accept */ { kAccept,  R,        R,        R,        kTail1,   kAfterE0, kTail2,   kAfterED, kAfterF0, kTail3,   kAfterF4, R },
+    /* Reject */ { R,        R,        R,        R,        R,        R,        R,        R,        R,        R,        R,        R },
+    /* Tail1  */ { R,        kAccept,  kAccept,  kAccept,  R,        R,        R,        R,        R,        R,        R,        R },
+    /* Tail2  */ { R,        kTail1,   kTail1,   kTail1,   R,        R,        R,        R,        R,        R,        R,        R },
+    /* Tail3  */ { R,        kTail2,   kTail2,   kTail2,   R,        R,        R,        R,        R,        R,        R,        R },
+    /* E0     */ { R,        R,        R,        kTail1,   R,        R,        R,        R,        R,        R,        R,        R },
+    /* ED     */ { R,        kTail1,   kTail1,   R,        R,        R,        R,        R,        R,        R,        R,        R },
+    /* F0     */ { R,        R,        kTail2,   kTail2,   R,        R,        R,        R,        R,        R,        R,        R },
+    /* F4     */ { R,        kTail2,   R,        R,        R,        R,        R,        R,        R,        R,        R,        R },
+};
+#undef R
+
+constexpr size_t kBlock = 16;
+
+// 从 p 开始连续的纯 ASCII 整块长度（按 16 字节对齐到块）
+inline size_t ascii_prefix(const unsigned char* p, size_t n) {
+    size_t i = 0;
+#ifdef UTF8_USE_SSE2
+    while (i + kBlock <= n) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        if (_mm_movemask_epi8(v) != 0) break;
+        i += kBlock;
+    }
+#else
+    while (i + 8 <= n) {
+        uint64_t w;
+        std::memcpy(&w, p + i, sizeof(w));
+        if (w & 0x8080808080808080ULL) break;
+        i += 8;
+    }
+#endif
+    return i;
+}
+
+bool validate_scalar(const unsigned char* p, size_t len)
+{
+    size_t i = 0;
+    uint8_t state = kAccept;
+    while (i < len) {
+        // 只有在字符边界上才能整块跳过 ASCII
+        if (state == kAccept) {
+            i += ascii_prefix(p + i, len - i);
+            if (i >= len) break;
+        }
+        // 含非 ASCII 的一块逐字节过状态机；字符边界上的 ASCII 字节不查表
+        const size_t stop = (len - i < kBlock) ? len : i + kBlock;
+        for (; i < stop; ++i) {
+            const unsigned char c = p[i];
+            if (c < 0x80 && state == kAccept) continue;
+            state = kTransition[state][kByteClass[c]];
+            if (state == kReject) return false;
+        }
+    }
+    return state == kAccept;
+}
+
+#ifdef UTF8_USE_SSSE3
+
+// 查表法（Keiser & Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte"）：
+// 每个字节与前一字节组成一对，分别用 前字节高半字节、前字节低半字节、本字节高半字节 查三张 16 项表，
+// 三者按位与后每一位对应一类错误；3 / 4 字节序列的第 3、4 字节另由再往前 2、3 个字节判断
+enum : uint8_t {
+    kTooShort = 1 << 0,     // 11______ 后跟 0_______ 或 11______
+    kTooLong = 1 << 1,      // 0_______ 后跟 10______
+    kOverlong3 = 1 << 2,    // 11100000 100_____
+    kTooLarge = 1 << 3,     // 11110100 1001____ / 101_____，以及 11110101 及以上后跟 1001____ / 101_____
+    kSurrogate = 1 << 4,    // 11101101 101_____
+    kOverlong2 = 1 << 5,    // 1100000_ 10______
+    kTooLarge1000 = 1 << 6, // 11110101 及以上后跟 1000____
+    kOverlong4 = 1 << 6,    // 11110000 1000____
+    kTwoConts = 1 << 7,     // 10______ 10______（是否合法由 3 / 4 字节序列的判断决定）
+    kCarry = kTooShort | kTooLong | kTwoConts,
+};
+
+alignas(16) const uint8_t kByte1High[16] = {
+    kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong,
+    kTwoConts, kTwoConts, kTwoConts, kTwoConts,
+    kTooShort | kOverlong2,
+    kTooShort,
+    kTooShort | kOverlong3 | kSurrogate,
+    kTooShort | kTooLarge | kTooLarge1000 | kOverlong4,
+};
+
+alignas(16) const uint8_t kByte1Low[16] = {
+    kCarry | kOverlong3 | kOverlong2 | kOverlong4,
+    kCarry | kOverlong2,
+    kCarry,
+    kCarry,
+    kCarry | kTooLarge,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000 | kSurrogate,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+};
+
+alignas(16) const uint8_t kByte2High[16] = {
+    kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort,
+    kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge1000 | kOverlong4,
+    kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge,
+    kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+    kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+    kTooShort, kTooShort, kTooShort, kTooShort,
+};
+
+// 块末尾 3 个字节若是尚未收完的首字节（分别 >= F0 / E0 / C0），饱和减法结果非零
+alignas(16) const uint8_t kIncompleteMax[16] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xF0 - 1, 0xE0 - 1, 0xC0 - 1,
+};
+
+struct Ssse3State {
+    __m128i prev;       // 上一块（跨块取前 1-3 个字节）
+    __m128i incomplete; // 上一块末尾未收完的首字节
+    __m128i error;      // 各块错误位累积
+};
+
+UTF8_SSSE3_TARGET
+inline __m128i high_nibbles(__m128i v) {
+    return _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0F));
+}
+
+UTF8_SSSE3_TARGET
+inline void check_block_ssse3(__m128i in, Ssse3State& s) {
+    if (_mm_movemask_epi8(in) == 0) {
+        // 纯 ASCII 块：只需确认上一块没有以未收完的序列结尾
+        s.error = _mm_or_si128(s.error, s.incomplete);
+        s.incomplete = _mm_setzero_si128();
+        s.prev = in;
+        return;
+    }
+    const __m128i prev1 = _mm_alignr_epi8(in, s.prev, 15);
+    const __m128i byte_1_high = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(kByte1High)), high_nibbles(prev1));
+    const __m128i byte_1_low = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(kByte1Low)),
+        _mm_and_si128(prev1, _mm_set1_epi8(0x0F)));
+    const __m128i byte_2_high = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(kByte2High)), high_nibbles(in));
+    const __m128i special = _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+
+    // 前 2 字节 >= E0 或前 3 字节 >= F0 时本字节必须是续字节，此时上面恰好只应报 kTwoConts
+    const __m128i prev2 = _mm_alignr_epi8(in, s.prev, 14);
+    const __m128i prev3 = _mm_alignr_epi8(in, s.prev, 13);
+    const __m128i third = _mm_subs_epu8(prev2, _mm_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+    const __m128i fourth = _mm_subs_epu8(prev3, _mm_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+    const __m128i must_be_cont = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8(static_cast<char>(0x80)));
+
+    s.error = _mm_or_si128(s.error, _mm_xor_si128(must_be_cont, special));
+    s.incomplete = _mm_subs_epu8(in, _mm_load_si128(reinterpret_cast<const __m128i*>(kIncompleteMax)));
+    s.prev = in;
+}
+
+UTF8_SSSE3_TARGET
+bool validate_ssse3(const unsigned char* p, size_t len)
+{
+    Ssse3State s{ _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128() };
+    size_t i = 0;
+    for (; i + kBlock <= len; i += kBlock) {
+        check_block_ssse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)), s);
+    }
+    if (i < len) {
+        // 不足一块的尾部补 0（ASCII）：被截断的序列会在补位处报 kTooShort
+        alignas(16) unsigned char tail[kBlock] = {};
+        std::memcpy(tail, p + i, len - i);
+        check_block_ssse3(_mm_load_si128(reinterpret_cast<const __m128i*>(tail)), s);
+    }
+    s.error = _mm_or_si128(s.error, s.incomplete);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(s.error, _mm_setzero_si128())) == 0xFFFF;
+}
+
+bool cpu_has_ssse3()
+{
+#if defined(__SSSE3__)
+    return true;
+#elif defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 9)) != 0;
+#else
+    return __builtin_cpu_supports("ssse3");
+#endif
+}
+
+#endif // UTF8_USE_SSSE3
+
+using Validator = bool (*)(const unsigned char*, size_t);
+
+Validator select_validator()
+{
+#ifdef UTF8_USE_SSSE3
+    if (cpu_has_ssse3()) return validate_ssse3;
+#endif
+    return validate_scalar;
+}
+
+} // namespace
+
+bool utf8_is_valid(const char* data, size_t len)
+{
+    // 局部静态：其他编译单元的静态初始化里调用也能拿到已选好的实现
+    static const Validator validate = select_validator();
+    return validate(reinterpret_cast<const unsigned char*>(data), len);
+}
@@ -0,0 +1,22 @@
+﻿#pragma once
+#ifndef UTF8_H
+#define UTF8_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// UTF-8 严格校验：拒绝过长编码、代理区（U+D800~U+DFFF）、超出 U+10FFFF 及截断序列
+// x86 上运行时检测到 SSSE3 时按 16 字节整块校验（查表法，多字节中文同样整块处理，纯 ASCII 块只做一次掩码判断）；
+// 否则纯 ASCII 段每次 16 字节（SSE2）/ 8 字节整体跳过，遇到多字节字符再逐字节走状态机
+bool utf8_is_valid(const char* data, size_t len);
+
+inline bool utf8_is_valid(std::string_view s) {
+    return utf8_is_valid(s.data(), s.size());
+}
+
+inline bool utf8_is_valid(const std::string& s) {
+    return utf8_is_valid(s.data(), s.size());
+}
+
+#endif // UTF8_H
@@ -2,15 +2,20 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include "async_logger.h"
 #include <nlohmann/json.hpp>
 #include <string>
 
 using json = nlohmann::json;
 
+// GBK <-> UTF-8（查表实现见 gbk_codec.h，非法字节以替换字符输出，不会失败）
 std::string gbk_to_utf8(const std::string& gbk_str);
+// 转换结果写入 out（覆盖原内容、复用其容量），返回被替换的非法字符数
+size_t gbk_to_utf8(const char* data, size_t len, std::string& out);
 std::string utf8_to_gbk(const std::string& utf8_str);
+void utf8_to_gbk(const char* data, size_t len, std::string& out);
 std::string trim_space(const std::string& str);
-bool is_at_bot(const json& msg_data);
+// 记录一条 Info 级日志（异步写出，带级别的写法见 async_logger.h）
 void write_log(const std::string& content);
 
 // 新增：统一的 @ 封装
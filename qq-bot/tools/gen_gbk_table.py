@@ -0,0 +1,31 @@
+#!/usr/bin/env python3
+# 由 Python 自带的 gbk 编解码器生成 src/utils/gbk_table.inc（GBK 双字节 -> Unicode 码点）
+# 用法：python tools/gen_gbk_table.py（输出带 BOM，MSVC 各配置都能按 UTF-8 读取注释）
+import os
+
+LEAD_FIRST, LEAD_LAST = 0x81, 0xFE
+TRAIL_FIRST, TRAIL_LAST = 0x40, 0xFE
+TRAIL_COUNT = TRAIL_LAST - TRAIL_FIRST + 1
+
+OUTPUT = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'src', 'utils', 'gbk_table.inc')
+
+def main():
+    values = []
+    for lead in range(LEAD_FIRST, LEAD_LAST + 1):
+        for trail in range(TRAIL_FIRST, TRAIL_LAST + 1):
+            try:
+                ch = bytes([lead, trail]).decode('gbk')
+                values.append(ord(ch) if len(ch) == 1 and ord(ch) <= 0xFFFF else 0)
+            except UnicodeDecodeError:
+                values.append(0)
+    lines = ['// 由 tools/gen_gbk_table.py 生成，请勿手工修改',
+             '// 下标 = (lead - 0x%02X) * %d + (trail - 0x%02X)，值为 Unicode 码点，0 表示未定义' % (LEAD_FIRST, TRAIL_COUNT, TRAIL_FIRST),
+             'static const uint16_t kGbkToUnicode[%d] = {' % len(values)]
+    for i in range(0, len(values), 16):
+        lines.append('    ' + ', '.join('0x%04X' % v for v in values[i:i + 16]) + ',')
+    lines.append('};')
+    with open(OUTPUT, 'w', encoding='utf-8-sig', newline='\n') as f:
+        f.write('\n'.join(lines) + '\n')
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,165 @@
+﻿// 入口分级检查：分片积压超过高水位时，无需 @ 的指令（绑定群聊、设置学期 等）仍按 Command 入队并执行，只有闲聊被丢弃
+//
+// 先逐条确认 group_message_priority 对无需 @ 的指令、@机器人 的消息与闲聊的分级；
+// 再用一个阻塞任务占住单分片的工作线程，灌入超过 INGRESS_HIGH_WATER 条闲聊后提交未 @ 的「绑定群聊」，
+// 放行后确认该指令已执行（本群成为查询群）且闲聊确有丢弃。任一项不符即打印并以非零退出
+//
+// 指令会写 group_mapping.json 等数据文件，检查在系统临时目录下的独立工作目录中运行，不碰仓库里的数据
+//
+// 用法：qq-bot-ingress-check（构建后自动运行一次，失败即构建失败）
+#include "config.h"
+#include "frame_router.h"
+#include "group_mapping.h"
+#include "msg_handler.h"
+#include "shard_executor.h"
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <future>
+#include <string>
+#include <vector>
+
+namespace {
+
+const long long kGroup = 700001;
+const long long kSender = 123456;
+
+GroupMessageEvent make_event(const std::string& raw)
+{
+    GroupMessageEvent ev;
+    ev.group_id = kGroup;
+    ev.user_id = kSender;
+    ev.raw_message = raw;
+    ev.has_group_id = ev.has_user_id = ev.has_raw_message = true;
+    return ev;
+}
+
+// 数组格式上报：同一文本作为单个 text 段
+GroupMessageEvent make_array_event(const std::string& text)
+{
+    GroupMessageEvent ev = make_event(text);
+    ev.message_segments.push_back(CqArraySegment{ "text", text });
+    ev.has_message_array = true;
+    return ev;
+}
+
+const char* priority_name(IngressPriority prio)
+{
+    switch (prio) {
+    case IngressPriority::Command: return "Command";
+    case IngressPriority::Game: return "Game";
+    case IngressPriority::Passive: return "Passive";
+    default: return "?";
+    }
+}
+
+int check_priorities()
+{
+    struct Case {
+        GroupMessageEvent ev;
+        IngressPriority expected;
+    };
+    const std::string at_bot = "[CQ:at,qq=" + std::string(BOT_QQ) + "] ";
+    const std::vector<Case> cases = {
+        { make_event(u8"绑定群聊"), IngressPriority::Command },
+        { make_event(u8" 取消绑定群聊 "), IngressPriority::Command },
+        { make_event(u8"解绑群聊"), IngressPriority::Command },
+        { make_event(u8"设置提醒群"), IngressPriority::Command },
+        { make_event(u8"设置学期 2025-09-01"), IngressPriority::Command },
+        { make_event("350234"), IngressPriority::Command },
+        { make_array_event(u8"绑定群聊"), IngressPriority::Command },
+        { make_event(at_bot + u8"查询课表"), IngressPriority::Command },
+        { make_event(u8"大家好"), IngressPriority::Passive },
+        { make_event(u8"绑定群聊了吗"), IngressPriority::Passive },
+    };
+    int failures = 0;
+    for (const auto& c : cases) {
+        const IngressPriority got = group_message_priority(c.ev);
+        if (got != c.expected) {
+            std::fprintf(stderr, "priority of \"%s\": got %s, expected %s\n",
+                c.ev.raw_message.c_str(), priority_name(got), priority_name(c.expected));
+            ++failures;
+        }
+    }
+    return failures;
+}
+
+int check_shedding()
+{
+    ShardExecutor executor(1, static_cast<std::size_t>(INGRESS_QUEUE_CAPACITY), static_cast<std::size_t>(INGRESS_HIGH_WATER));
+
+    // 占住唯一的工作线程，之后提交的任务全部留在队列里
+    std::promise<void> started;
+    std::promise<void> release;
+    std::shared_future<void> gate = release.get_future().share();
+    executor.post(0, IngressPriority::Command, [&started, gate] {
+        started.set_value();
+        gate.wait();
+    });
+    started.get_future().wait();
+
+    std::size_t chat_shed = 0;
+    const int chat_count = INGRESS_HIGH_WATER + 64;
+    for (int i = 0; i < chat_count; ++i) {
+        GroupMessageEvent ev = make_event(u8"闲聊 " + std::to_string(i));
+        const IngressPriority prio = group_message_priority(ev);
+        if (!executor.post(kGroup, prio, [ev = std::move(ev)] { handle_group_message(ev); })) ++chat_shed;
+    }
+
+    std::atomic<bool> ran{ false };
+    GroupMessageEvent bind = make_event(u8"绑定群聊");
+    const IngressPriority bind_prio = group_message_priority(bind);
+    const bool accepted = executor.post(kGroup, bind_prio, [bind = std::move(bind), &ran] {
+        handle_group_message(bind);
+        ran = true;
+    });
+
+    release.set_value();
+    executor.stop();
+
+    int failures = 0;
+    if (chat_shed == 0) {
+        std::fprintf(stderr, "no chat message was shed after %d posts (high water %d)\n", chat_count, INGRESS_HIGH_WATER);
+        ++failures;
+    }
+    if (!accepted || !ran) {
+        std::fprintf(stderr, "unaddressed bind command was %s past high water (priority %s)\n",
+            accepted ? "accepted but not run" : "shed", priority_name(bind_prio));
+        ++failures;
+    }
+    if (get_query_groups().count(std::to_string(kGroup)) == 0) {
+        std::fprintf(stderr, "group %lld is not a query group after the bind command\n", kGroup);
+        ++failures;
+    }
+    if (failures == 0) {
+        std::printf("shed %zu of %d chat messages past high water, bind command still ran\n", chat_shed, chat_count);
+    }
+    return failures;
+}
+
+} // namespace
+
+int main()
+{
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    const fs::path work_dir = fs::temp_directory_path(ec) / "qq-bot-ingress-check";
+    fs::remove_all(work_dir, ec);
+    fs::create_directories(work_dir, ec);
+    fs::current_path(work_dir, ec);
+    if (ec) {
+        std::fprintf(stderr, "cannot use work directory %s: %s\n", work_dir.string().c_str(), ec.message().c_str());
+        return 2;
+    }
+
+    init_group_mapping();
+    init_command_registry();
+
+    const int failures = check_priorities() + check_shedding();
+    if (failures != 0) {
+        std::fprintf(stderr, "ingress check failed: %d problem(s)\n", failures);
+        return 1;
+    }
+    std::printf("ingress check passed\n");
+    return 0;
+}
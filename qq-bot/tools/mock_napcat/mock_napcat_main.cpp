@@ -0,0 +1,436 @@
+﻿// 本地模拟 OneBot v11 / NapCat 服务端（压测用）：在 WS_HOST:WS_PORT 上等待机器人连接，
+// 按设定速率在 N 个群、M 个用户间生成群消息（@机器人 指令与普通闲聊按比例混合），
+// 以接近真实的载荷与延迟回执 send_group_msg / get_group_member_list，并从外部统计端到端回复延迟与发送吞吐
+//
+// 用法：qq-bot-mock-napcat [--rate 条/秒] [--groups N] [--users M] [--command-ratio 0~1] [--duration 秒]
+//                          [--api-latency-ms 毫秒] [--member-list-latency-ms 毫秒] [--heartbeat-ms 毫秒]
+//                          [--drain-ms 毫秒] [--commands 你好,hello,...] [--no-deflate]
+// 端到端延迟：@机器人 指令发出 -> 收到 @该用户 的 send_group_msg；机器人对同一群的回复保持顺序，按群 FIFO 配对
+#include "config.h"
+#include <boost/asio.hpp>
+#include <boost/beast.hpp>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
+namespace asio = boost::asio;
+namespace beast = boost::beast;
+namespace websocket = beast::websocket;
+using tcp = asio::ip::tcp;
+using steady_clock = std::chrono::steady_clock;
+using nlohmann::json;
+
+namespace {
+
+struct Options {
+    double rate = 20.0;               // 群消息 条/秒（所有群合计）
+    int groups = 10;
+    int users = 50;
+    double command_ratio = 0.3;       // @机器人 指令所占比例，其余为闲聊
+    int duration_sec = 30;
+    int api_latency_ms = 20;          // send_group_msg 回执延迟均值（实际在 0.5~1.5 倍间抖动）
+    int member_list_latency_ms = 200; // get_group_member_list 回执延迟均值
+    int heartbeat_ms = 5000;
+    int drain_ms = 5000;              // 停止发消息后等待剩余回复的时长
+    bool deflate = true;
+    std::vector<std::string> commands{ u8"你好", "hello", u8"帮助", "1" };
+};
+
+std::vector<std::string> split_commas(const std::string& s)
+{
+    std::vector<std::string> out;
+    std::size_t begin = 0;
+    while (begin <= s.size()) {
+        const std::size_t comma = s.find(',', begin);
+        const std::size_t end = comma == std::string::npos ? s.size() : comma;
+        if (end > begin) out.push_back(s.substr(begin, end - begin));
+        if (comma == std::string::npos) break;
+        begin = comma + 1;
+    }
+    return out;
+}
+
+bool parse_options(int argc, char* argv[], Options& opt)
+{
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--no-deflate") {
+            opt.deflate = false;
+            continue;
+        }
+        if (i + 1 >= argc) return false;
+        const char* value = argv[++i];
+        if (arg == "--rate") opt.rate = std::atof(value);
+        else if (arg == "--groups") opt.groups = std::atoi(value);
+        else if (arg == "--users") opt.users = std::atoi(value);
+        else if (arg == "--command-ratio") opt.command_ratio = std::atof(value);
+        else if (arg == "--duration") opt.duration_sec = std::atoi(value);
+        else if (arg == "--api-latency-ms") opt.api_latency_ms = std::atoi(value);
+        else if (arg == "--member-list-latency-ms") opt.member_list_latency_ms = std::atoi(value);
+        else if (arg == "--heartbeat-ms") opt.heartbeat_ms = std::atoi(value);
+        else if (arg == "--drain-ms") opt.drain_ms = std::atoi(value);
+        else if (arg == "--commands") opt.commands = split_commas(value);
+        else return false;
+    }
+    return opt.rate > 0.0 && opt.groups > 0 && opt.users > 0 && opt.duration_sec > 0
+        && opt.command_ratio >= 0.0 && opt.command_ratio <= 1.0 && !opt.commands.empty();
+}
+
+// 闲聊文本：短句为主，少量长句与 CQ 表情；取值集合小，偶尔会凑出连续三条相同消息触发 +1
+const char* const kChat[] = {
+    u8"哈哈哈", u8"有人吗", u8"今天食堂好挤", u8"[CQ:face,id=178]", u8"明天几点上课来着",
+    u8"作业写完了吗？交的是第三章还是第四章，老师上节课说的我没听清", "6", u8"草",
+    u8"复读", u8"这个题怎么做 [CQ:image,file=abc.jpg,url=https://example.invalid/abc.jpg]",
+};
+
+long long unix_now()
+{
+    return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+long long group_id_of(int index) { return 700000 + index; }
+long long user_id_of(int index) { return 20000 + index; }
+
+class MockNapcat {
+public:
+    MockNapcat(asio::io_context& ioc, const Options& opt, tcp::socket socket)
+        : ioc_(ioc), opt_(opt), ws_(std::move(socket)), gen_timer_(ioc), heartbeat_timer_(ioc), report_timer_(ioc), stop_timer_(ioc),
+          rng_(std::random_device{}()) {}
+
+    void start() {
+        if (opt_.deflate) {
+            websocket::permessage_deflate pmd;
+            pmd.server_enable = true;
+            ws_.set_option(pmd);
+        }
+        ws_.set_option(websocket::stream_base::timeout::suggested(beast::role_type::server));
+        ws_.async_accept([this](beast::error_code ec) {
+            if (ec) {
+                std::fprintf(stderr, "websocket accept failed: %s\n", ec.message().c_str());
+                return;
+            }
+            std::printf("bot connected, generating %.1f msgs/sec for %ds across %d groups / %d users\n",
+                opt_.rate, opt_.duration_sec, opt_.groups, opt_.users);
+            started_ = steady_clock::now();
+            next_message_at_ = started_;
+            ws_.text(true);
+            send(json{ { "time", unix_now() }, { "self_id", self_id() }, { "post_type", "meta_event" },
+                { "meta_event_type", "lifecycle" }, { "sub_type", "connect" } }.dump());
+            start_read();
+            schedule_heartbeat();
+            schedule_report();
+            schedule_generate();
+            stop_timer_.expires_after(std::chrono::seconds(opt_.duration_sec));
+            stop_timer_.async_wait([this](beast::error_code e) {
+                if (e) return;
+                generating_ = false;
+                gen_timer_.cancel();
+                stopped_at_ = steady_clock::now();
+                stop_timer_.expires_after(std::chrono::milliseconds(opt_.drain_ms));
+                stop_timer_.async_wait([this](beast::error_code e2) {
+                    if (!e2) finish("run finished");
+                });
+            });
+        });
+    }
+
+private:
+    static long long self_id() { return std::atoll(BOT_QQ); }
+
+    // 出站帧排队，保证同一时刻只有一个 async_write
+    void send(std::string frame) {
+        if (closed_) return;
+        outbox_.push_back(std::move(frame));
+        if (outbox_.size() == 1) write_next();
+    }
+
+    void write_next() {
+        ws_.async_write(asio::buffer(outbox_.front()), [this](beast::error_code ec, std::size_t) {
+            if (ec) {
+                finish("write failed: " + ec.message());
+                return;
+            }
+            outbox_.pop_front();
+            if (!outbox_.empty()) write_next();
+        });
+    }
+
+    void start_read() {
+        ws_.async_read(buffer_, [this](beast::error_code ec, std::size_t) {
+            if (ec) {
+                finish("bot disconnected: " + ec.message());
+                return;
+            }
+            on_request(beast::buffers_to_string(buffer_.data()));
+            buffer_.clear();
+            start_read();
+        });
+    }
+
+    void schedule_heartbeat() {
+        heartbeat_timer_.expires_after(std::chrono::milliseconds(opt_.heartbeat_ms));
+        heartbeat_timer_.async_wait([this](beast::error_code ec) {
+            if (ec || closed_) return;
+            send(json{ { "time", unix_now() }, { "self_id", self_id() }, { "post_type", "meta_event" },
+                { "meta_event_type", "heartbeat" }, { "status", { { "online", true }, { "good", true } } },
+                { "interval", opt_.heartbeat_ms } }.dump());
+            schedule_heartbeat();
+        });
+    }
+
+    // 按固定间隔排出消息：定时器晚到时一次补发所有已到期的消息，保持平均速率
+    void schedule_generate() {
+        gen_timer_.expires_at(next_message_at_);
+        gen_timer_.async_wait([this](beast::error_code ec) {
+            if (ec || closed_ || !generating_) return;
+            const auto interval = std::chrono::duration_cast<steady_clock::duration>(std::chrono::duration<double>(1.0 / opt_.rate));
+            const auto now = steady_clock::now();
+            while (next_message_at_ <= now) {
+                send_group_message();
+                next_message_at_ += interval;
+            }
+            schedule_generate();
+        });
+    }
+
+    void send_group_message() {
+        std::uniform_int_distribution<int> pick_group(0, opt_.groups - 1);
+        std::uniform_int_distribution<int> pick_user(0, opt_.users - 1);
+        std::uniform_real_distribution<double> coin(0.0, 1.0);
+        const long long group_id = group_id_of(pick_group(rng_));
+        const int user = pick_user(rng_);
+        const long long user_id = user_id_of(user);
+
+        std::string text;
+        if (coin(rng_) < opt_.command_ratio) {
+            std::uniform_int_distribution<std::size_t> pick(0, opt_.commands.size() - 1);
+            text = "[CQ:at,qq=" + std::string(BOT_QQ) + "] " + opt_.commands[pick(rng_)];
+            pending_[group_id].push_back(steady_clock::now());
+            ++commands_sent_;
+        } else {
+            std::uniform_int_distribution<std::size_t> pick(0, sizeof(kChat) / sizeof(kChat[0]) - 1);
+            text = kChat[pick(rng_)];
+        }
+        ++messages_sent_;
+
+        const std::string nickname = u8"用户" + std::to_string(user);
+        send(json{
+            { "self_id", self_id() }, { "user_id", user_id }, { "time", unix_now() }, { "message_id", ++message_id_ },
+            { "message_seq", message_id_ }, { "real_id", message_id_ }, { "message_type", "group" },
+            { "sender", { { "user_id", user_id }, { "nickname", nickname }, { "card", user % 3 == 0 ? std::string() : nickname + u8"的名片" },
+                { "role", user == 0 ? "owner" : "member" } } },
+            { "raw_message", text }, { "font", 14 }, { "sub_type", "normal" }, { "message", text },
+            { "message_format", "string" }, { "post_type", "message" }, { "group_id", group_id } }.dump());
+    }
+
+    // 机器人发来的 action 请求：按类型延迟回执
+    void on_request(const std::string& frame) {
+        json req = json::parse(frame, nullptr, false);
+        if (req.is_discarded() || !req.contains("action")) {
+            ++bad_requests_;
+            return;
+        }
+        const std::string action = req["action"].is_string() ? req["action"].get<std::string>() : std::string();
+        const json echo = req.contains("echo") ? req["echo"] : json();
+        const json& params = req.contains("params") ? req["params"] : json::object();
+
+        json data;
+        int latency_ms = opt_.api_latency_ms;
+        if (action == "send_group_msg") {
+            on_group_reply(params);
+            data = { { "message_id", ++message_id_ } };
+        } else if (action == "get_group_member_list") {
+            data = member_list(params.contains("group_id") ? params["group_id"] : json());
+            latency_ms = opt_.member_list_latency_ms;
+        } else {
+            ++other_actions_;
+            respond(echo, json(), 1404, "unsupported action", latency_ms);
+            return;
+        }
+        respond(echo, std::move(data), 0, "", latency_ms);
+    }
+
+    void respond(json echo, json data, int retcode, const std::string& wording, int latency_ms) {
+        std::uniform_real_distribution<double> jitter(0.5, 1.5);
+        auto timer = std::make_shared<asio::steady_timer>(ioc_);
+        timer->expires_after(std::chrono::microseconds(static_cast<long long>(latency_ms * 1000 * jitter(rng_))));
+        json resp = { { "status", retcode == 0 ? "ok" : "failed" }, { "retcode", retcode }, { "data", std::move(data) },
+            { "message", wording }, { "wording", wording }, { "echo", std::move(echo) } };
+        timer->async_wait([this, timer, body = resp.dump()](beast::error_code ec) mutable {
+            if (!ec) send(std::move(body));
+        });
+    }
+
+    // 回复与指令按群 FIFO 配对：只有 @用户 的回复算作指令回复（+1 表情包等其他回复单独计数）
+    void on_group_reply(const json& params) {
+        const auto now = steady_clock::now();
+        ++replies_;
+        ++replies_this_second_;
+        last_reply_at_ = now;
+        const std::string message = params.contains("message") && params["message"].is_string()
+            ? params["message"].get<std::string>() : std::string();
+        long long group_id = 0;
+        if (params.contains("group_id")) {
+            const json& g = params["group_id"];
+            group_id = g.is_string() ? std::atoll(g.get<std::string>().c_str()) : g.is_number_integer() ? g.get<long long>() : 0;
+        }
+        auto it = pending_.find(group_id);
+        if (message.rfind("[CQ:at,qq=", 0) != 0 || it == pending_.end() || it->second.empty()) {
+            ++other_replies_;
+            return;
+        }
+        latencies_us_.push_back(std::chrono::duration_cast<std::chrono::microseconds>(now - it->second.front()).count());
+        it->second.pop_front();
+    }
+
+    json member_list(const json& group) const {
+        json members = json::array();
+        const long long group_id = group.is_string() ? std::atoll(group.get<std::string>().c_str())
+            : group.is_number_integer() ? group.get<long long>() : 0;
+        const long long join_time = unix_now() - 86400 * 30;
+        for (int u = 0; u < opt_.users; ++u) {
+            const std::string nickname = u8"用户" + std::to_string(u);
+            members.push_back({ { "group_id", group_id }, { "user_id", user_id_of(u) }, { "nickname", nickname },
+                { "card", u % 3 == 0 ? std::string() : nickname + u8"的名片" }, { "sex", "unknown" }, { "age", 0 }, { "area", "" },
+                { "join_time", join_time + u }, { "last_sent_time", unix_now() }, { "level", "1" },
+                { "role", u == 0 ? "owner" : "member" }, { "unfriendly", false }, { "title", "" },
+                { "title_expire_time", 0 }, { "card_changeable", true } });
+        }
+        return members;
+    }
+
+    void schedule_report() {
+        report_timer_.expires_after(std::chrono::seconds(1));
+        report_timer_.async_wait([this](beast::error_code ec) {
+            if (ec || closed_) return;
+            std::printf("t=%llds sent=%llu commands=%llu replies=%llu (%llu/s) awaiting=%zu\n",
+                static_cast<long long>(std::chrono::duration_cast<std::chrono::seconds>(steady_clock::now() - started_).count()),
+                messages_sent_, commands_sent_, replies_, replies_this_second_, awaiting());
+            peak_replies_per_sec_ = (std::max)(peak_replies_per_sec_, replies_this_second_);
+            replies_this_second_ = 0;
+            schedule_report();
+        });
+    }
+
+    std::size_t awaiting() const {
+        std::size_t n = 0;
+        for (const auto& kv : pending_) n += kv.second.size();
+        return n;
+    }
+
+    void finish(const std::string& reason) {
+        if (closed_) return;
+        closed_ = true;
+        gen_timer_.cancel();
+        heartbeat_timer_.cancel();
+        report_timer_.cancel();
+        stop_timer_.cancel();
+        print_report(reason);
+        beast::error_code ignored;
+        beast::get_lowest_layer(ws_).close(ignored);
+        ioc_.stop(); // 只服务一次连接：报告输出后即退出，不等延迟回执等剩余定时器
+    }
+
+    void print_report(const std::string& reason) {
+        const auto end = generating_ ? steady_clock::now() : stopped_at_;
+        const double elapsed = (std::max)(1e-9, std::chrono::duration<double>(end - started_).count());
+        std::printf("\n%s\n", reason.c_str());
+        std::printf("sent %llu group messages (%llu commands) in %.2fs, %.1f msgs/sec\n",
+            messages_sent_, commands_sent_, elapsed, static_cast<double>(messages_sent_) / elapsed);
+        const double reply_span = (std::max)(1e-9, std::chrono::duration<double>(last_reply_at_ - started_).count());
+        std::printf("send_group_msg received: %llu (%.1f/sec until the last reply, peak %llu/sec), %llu not matched to a command\n",
+            replies_, replies_ == 0 ? 0.0 : static_cast<double>(replies_) / reply_span, peak_replies_per_sec_, other_replies_);
+        std::printf("commands without reply: %zu, unsupported actions: %llu, unparsable requests: %llu\n",
+            awaiting(), other_actions_, bad_requests_);
+        if (latencies_us_.empty()) {
+            std::printf("end-to-end reply latency: no samples\n");
+            return;
+        }
+        std::sort(latencies_us_.begin(), latencies_us_.end());
+        auto pct = [this](double p) {
+            const std::size_t i = static_cast<std::size_t>(p * static_cast<double>(latencies_us_.size() - 1));
+            return latencies_us_[i] / 1000.0;
+        };
+        std::printf("end-to-end reply latency (ms): n=%zu p50=%.2f p90=%.2f p99=%.2f max=%.2f\n",
+            latencies_us_.size(), pct(0.5), pct(0.9), pct(0.99), latencies_us_.back() / 1000.0);
+    }
+
+    asio::io_context& ioc_;
+    const Options& opt_;
+    websocket::stream<tcp::socket> ws_;
+    beast::flat_buffer buffer_;
+    std::deque<std::string> outbox_;
+    asio::steady_timer gen_timer_;
+    asio::steady_timer heartbeat_timer_;
+    asio::steady_timer report_timer_;
+    asio::steady_timer stop_timer_;
+    std::mt19937 rng_;
+
+    bool generating_ = true;
+    bool closed_ = false;
+    steady_clock::time_point started_;
+    steady_clock::time_point stopped_at_;
+    steady_clock::time_point next_message_at_;
+    steady_clock::time_point last_reply_at_;
+    long long message_id_ = 0;
+
+    std::map<long long, std::deque<steady_clock::time_point>> pending_; // 各群尚未收到回复的指令发出时间
+    std::vector<long long> latencies_us_;
+    unsigned long long messages_sent_ = 0;
+    unsigned long long commands_sent_ = 0;
+    unsigned long long replies_ = 0;
+    unsigned long long replies_this_second_ = 0;
+    unsigned long long peak_replies_per_sec_ = 0;
+    unsigned long long other_replies_ = 0;
+    unsigned long long other_actions_ = 0;
+    unsigned long long bad_requests_ = 0;
+};
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+#ifdef _WIN32
+    SetConsoleOutputCP(CP_UTF8);
+#endif
+    Options opt;
+    if (!parse_options(argc, argv, opt)) {
+        std::fprintf(stderr, "usage: qq-bot-mock-napcat [--rate N] [--groups N] [--users N] [--command-ratio 0-1] [--duration sec]\n"
+            "       [--api-latency-ms N] [--member-list-latency-ms N] [--heartbeat-ms N] [--drain-ms N] [--commands a,b,...] [--no-deflate]\n");
+        return 2;
+    }
+
+    try {
+        asio::io_context ioc;
+        tcp::acceptor acceptor(ioc, tcp::endpoint(asio::ip::make_address(WS_HOST), static_cast<unsigned short>(std::atoi(WS_PORT))));
+        std::printf("mock NapCat listening on ws://%s:%s%s (bot QQ %s)\n", WS_HOST, WS_PORT, WS_PATH, BOT_QQ);
+        std::unique_ptr<MockNapcat> server;
+        acceptor.async_accept([&](beast::error_code ec, tcp::socket socket) {
+            if (ec) {
+                std::fprintf(stderr, "accept failed: %s\n", ec.message().c_str());
+                return;
+            }
+            acceptor.close(); // 只服务一个机器人连接
+            server.reset(new MockNapcat(ioc, opt, std::move(socket)));
+            server->start();
+        });
+        ioc.run();
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "mock NapCat: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
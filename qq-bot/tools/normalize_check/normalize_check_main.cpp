@@ -0,0 +1,187 @@
+﻿// 指令文本规范化差分检查：normalize_text_into 与旧版 legacy::normalize_text 逐字节比对，不一致时返回非零
+// 两者只在输入为合法 UTF-8 时保证一致（帧入口已用 utf8_is_valid 把关，非法输入到不了规范化），
+// 因此字节级变异产生的非法 UTF-8 用例会被跳过并计数，不参与比对
+//
+// 用例来源：真实样例（指令、粘贴的课表、夹带实体与不可见字符的消息）做随机插入 / 删除 / 替换 / 复制变异，
+// 随机片段拼接（含残缺实体与 "&amp;#123;" 这类二次解码组合），以及随机码点序列
+//
+// 用法：qq-bot-normalize-check [--seed N] [--iterations N]
+//   默认每次运行取新的随机种子并打印出来，失败时用同一 --seed 复现；构建后事件会运行一次，失败即构建失败
+#include "legacy_msg_handler.h"
+#include "text_normalize.h"
+#include "utf8.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 变异起点：取自平时的指令与消息形态
+const std::vector<std::string>& seed_inputs() {
+    static const std::vector<std::string> s = {
+        u8" ​课表 周三　",
+        u8"﻿明天有什么课",
+        u8"第3节　高等数学 &#91;教A-101&#93;　周1-16\r\n第5节 大学英语 &#91;外语楼 204&#93; 周2-17\r\n",
+        u8"[CQ:at,qq=10001] 导入课表 高等数学，周一，1-2节，1-16周，教A-101；大学物理，周三，3-4节，2-17周",
+        u8"&quot;引用&quot; &amp;#123;x&amp;#125; &amp;#91;y&amp;#93; &#123;&#125;",
+        u8"[CQ:image,file=abc.jpg,url=https://example.com/a?b=1&amp;c=2]\t看看",
+        "",
+    };
+    return s;
+}
+
+// 拼接 / 插入用的片段：普通文本、各类不可见字符、控制字符、完整或残缺的实体
+const std::vector<std::string>& pieces() {
+    static const std::vector<std::string> p = {
+        "a", "1", " ", "\t", "\r\n", "\x01", "\x7f", u8"课", u8"表",
+        "\xEF\xBB\xBF", "\xE2\x80\x8B", "\xC2\xA0", "\xE3\x80\x80",
+        "&", "#", ";", "amp", "quot", "91", "93", "123", "125",
+        "&#91;", "&#93;", "&quot;", "&amp;", "&#123;", "&#125;", "&#12", "&am",
+    };
+    return p;
+}
+
+void append_code_point(std::string& s, uint32_t cp) {
+    if (cp < 0x80) {
+        s += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        s += static_cast<char>(0xC0 | (cp >> 6));
+        s += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        s += static_cast<char>(0xE0 | (cp >> 12));
+        s += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        s += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        s += static_cast<char>(0xF0 | (cp >> 18));
+        s += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        s += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        s += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+class CaseGenerator {
+public:
+    explicit CaseGenerator(uint32_t seed) : rng_(seed) {}
+
+    void next(std::string& in) {
+        switch (uniform(0, 2)) {
+        case 0: mutate(in); break;
+        case 1: concat_pieces(in); break;
+        default: random_code_points(in); break;
+        }
+    }
+
+private:
+    size_t uniform(size_t lo, size_t hi) {
+        return std::uniform_int_distribution<size_t>(lo, hi)(rng_);
+    }
+
+    const std::string& any_piece() {
+        const auto& p = pieces();
+        return p[uniform(0, p.size() - 1)];
+    }
+
+    void concat_pieces(std::string& in) {
+        in.clear();
+        for (size_t n = uniform(0, 24); n > 0; --n) in += any_piece();
+    }
+
+    // 码点混合 ASCII（含控制字符）、拉丁 / CJK 与增补平面，跳过代理区
+    void random_code_points(std::string& in) {
+        in.clear();
+        for (size_t n = uniform(0, 32); n > 0; --n) {
+            uint32_t cp;
+            switch (uniform(0, 3)) {
+            case 0: cp = static_cast<uint32_t>(uniform(0, 0x7F)); break;
+            case 1: cp = static_cast<uint32_t>(uniform(0x80, 0x7FF)); break;
+            case 2:
+                cp = static_cast<uint32_t>(uniform(0x800, 0xFFFF));
+                if (cp >= 0xD800 && cp <= 0xDFFF) cp = 0x3000;
+                break;
+            default: cp = static_cast<uint32_t>(uniform(0x10000, 0x10FFFF)); break;
+            }
+            append_code_point(in, cp);
+        }
+    }
+
+    // 在样例上做若干次变异；位置按字节取，可能切开多字节字符，由调用方按合法性过滤
+    void mutate(std::string& in) {
+        const auto& seeds = seed_inputs();
+        in = seeds[uniform(0, seeds.size() - 1)];
+        for (size_t n = uniform(1, 6); n > 0; --n) {
+            const size_t pos = uniform(0, in.size());
+            const size_t len = (std::min)(uniform(0, 8), in.size() - pos);
+            switch (uniform(0, 4)) {
+            case 0: in.insert(pos, any_piece()); break;
+            case 1: in.erase(pos, len); break;
+            case 2: in.replace(pos, len, any_piece()); break;
+            case 3: in.insert(pos, in.substr(pos, len)); break;
+            default: in.insert(pos, 1, static_cast<char>(uniform(0, 0xFF))); break;
+            }
+        }
+    }
+
+    std::mt19937 rng_;
+};
+
+void print_hex(const char* label, const std::string& s) {
+    std::fprintf(stderr, "%s (%zu bytes):", label, s.size());
+    for (unsigned char c : s) std::fprintf(stderr, " %02X", c);
+    std::fprintf(stderr, "\n");
+}
+
+bool parse_number(const char* text, unsigned long long& value) {
+    char* end = nullptr;
+    value = std::strtoull(text, &end, 10);
+    return end != text && *end == '\0';
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    unsigned long long seed = std::random_device{}();
+    unsigned long long iterations = 200000;
+    for (int i = 1; i < argc; ++i) {
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--seed") == 0 && has_value && parse_number(argv[i + 1], seed)) {
+            ++i;
+        } else if (std::strcmp(argv[i], "--iterations") == 0 && has_value && parse_number(argv[i + 1], iterations)) {
+            ++i;
+        } else {
+            std::fprintf(stderr, "usage: %s [--seed N] [--iterations N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::printf("normalize check: seed=%llu iterations=%llu\n", seed, iterations);
+    std::fflush(stdout);
+    CaseGenerator gen(static_cast<uint32_t>(seed));
+    std::string in;
+    std::string out;
+    unsigned long long compared = 0;
+    unsigned long long skipped = 0;
+    for (unsigned long long i = 0; i < iterations; ++i) {
+        gen.next(in);
+        if (!utf8_is_valid(in)) {
+            ++skipped;
+            continue;
+        }
+        normalize_text_into(in, out);
+        const std::string expected = legacy::normalize_text(in);
+        ++compared;
+        if (out != expected) {
+            std::fprintf(stderr, "normalize mismatch at iteration %llu (seed=%llu)\n", i, seed);
+            print_hex("input", in);
+            print_hex("legacy", expected);
+            print_hex("single-pass", out);
+            return 1;
+        }
+    }
+    std::printf("normalize check passed: %llu compared, %llu invalid UTF-8 skipped\n", compared, skipped);
+    return 0;
+}
@@ -0,0 +1,190 @@
+﻿// 抓包回放：把 frame_capture 记录的原始帧送入完整的 解码 -> 分片 -> handle_group_message 处理链，
+// 出站帧交给进程内的模拟 socket（立即回执），最后输出吞吐与各阶段耗时分位数，用于在真实流量上对比改动
+//
+// 用法：qq-bot-replay <抓包文件> [--pace] [--speed 倍数] [--shards N] [--repeat N]
+//   默认尽快回放（入口队列过深时等待分片消化，避免触发闲聊丢弃）；--pace 按录制时的间隔回放，--speed 加快 / 放慢
+// 指令处理会读写工作目录下的数据文件（课表、成员名等），请在数据副本目录中运行
+#include "config.h"
+#include "utils.h"
+#include "frame_capture.h"
+#include "frame_router.h"
+#include "msg_handler.h"
+#include "outbound_scheduler.h"
+#include "pipeline_stats.h"
+#include "ws_send_queue.h"
+#include "group_mapping.h"
+#include "member_cache.h"
+#include "schedule.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
+using steady_clock = std::chrono::steady_clock;
+
+namespace {
+
+struct Options {
+    std::string path;
+    bool pace = false;
+    double speed = 1.0;
+    int shards = MESSAGE_SHARDS;
+    int repeat = 1;
+};
+
+bool parse_options(int argc, char* argv[], Options& opt)
+{
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--pace") {
+            opt.pace = true;
+        } else if (arg == "--speed" && has_value) {
+            opt.speed = std::atof(argv[++i]);
+        } else if (arg == "--shards" && has_value) {
+            opt.shards = std::atoi(argv[++i]);
+        } else if (arg == "--repeat" && has_value) {
+            opt.repeat = std::atoi(argv[++i]);
+        } else if (opt.path.empty() && arg.rfind("--", 0) != 0) {
+            opt.path = arg;
+        } else {
+            return false;
+        }
+    }
+    return !opt.path.empty() && opt.speed > 0.0 && opt.repeat > 0;
+}
+
+// 取 "key":"value" 中的 value（出站帧由本程序自己生成，格式固定，不必完整解析 JSON）
+std::string_view field_string(std::string_view frame, std::string_view key)
+{
+    const std::string pattern = "\"" + std::string(key) + "\":\"";
+    const std::size_t p = frame.find(pattern);
+    if (p == std::string_view::npos) return {};
+    const std::size_t begin = p + pattern.size();
+    const std::size_t end = frame.find('"', begin);
+    return end == std::string_view::npos ? std::string_view() : frame.substr(begin, end - begin);
+}
+
+// 模拟 socket：统计出站帧，并像 NapCat 一样对每个请求立即回执（回执同样经帧路由进入分片）
+class MockSocket {
+public:
+    void on_frame(std::string frame) {
+        frames_.fetch_add(1, std::memory_order_relaxed);
+        const std::string_view action = field_string(frame, "action");
+        if (action == "send_group_msg") group_msgs_.fetch_add(1, std::memory_order_relaxed);
+
+        const std::size_t p = frame.rfind("\"echo\":");
+        if (p == std::string::npos) return;
+        const std::size_t begin = p + 7;
+        const std::string echo = frame.substr(begin, frame.find_first_of(",}", begin) - begin);
+        const char* data = action == "get_group_member_list" ? "[]" : "{\"message_id\":1}";
+        const std::string ack = std::string("{\"status\":\"ok\",\"retcode\":0,\"data\":") + data + ",\"echo\":" + echo + "}";
+        frame_router_on_frame(ack, steady_clock::now());
+    }
+
+    unsigned long long frames() const { return frames_.load(std::memory_order_relaxed); }
+    unsigned long long group_msgs() const { return group_msgs_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<unsigned long long> frames_{ 0 };
+    std::atomic<unsigned long long> group_msgs_{ 0 };
+};
+
+void print_histogram(const char* name, const Log2Histogram& h)
+{
+    const unsigned long long n = h.count();
+    const double mean = n == 0 ? 0.0
+        : static_cast<double>(h.samples.total.load(std::memory_order_relaxed)) / static_cast<double>(n);
+    std::printf("  n=%-8llu mean=%-10.1f p50=%-8llu p90=%-8llu p99=%-8llu max=%-8llu %s\n", n, mean,
+        h.percentile(0.5), h.percentile(0.9), h.percentile(0.99), h.max(), name);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+#ifdef _WIN32
+    SetConsoleOutputCP(CP_UTF8);
+#endif
+    Options opt;
+    if (!parse_options(argc, argv, opt)) {
+        std::fprintf(stderr, "usage: qq-bot-replay <capture file> [--pace] [--speed X] [--shards N] [--repeat N]\n");
+        return 2;
+    }
+
+    // 整个抓包先读入内存，回放过程中不做文件 IO
+    FrameCaptureReader reader;
+    std::string error;
+    if (!reader.open(opt.path, error)) {
+        std::fprintf(stderr, "replay: %s\n", error.c_str());
+        return 1;
+    }
+    std::vector<CapturedFrame> frames;
+    CapturedFrame f;
+    while (reader.next(f)) frames.push_back(f);
+    if (reader.truncated()) {
+        std::fprintf(stderr, "replay: capture ends with an incomplete record, ignored\n");
+    }
+    if (frames.empty()) {
+        std::fprintf(stderr, "replay: capture has no frames\n");
+        return 1;
+    }
+    const std::uint64_t span_ns = frames.back().offset_ns + 1;
+
+    log_set_console(false); // 日志照常写入 robot_log.txt，控制台只输出回放结果
+    init_group_mapping();
+    init_member_cache();
+    init_schedules();
+    init_command_registry();
+
+    MockSocket socket;
+    ws_send_attach_sink([&socket](std::string frame) { socket.on_frame(std::move(frame)); });
+    frame_router_start(opt.shards);
+    outbound_scheduler_start();
+
+    const std::size_t backlog_limit = static_cast<std::size_t>(INGRESS_HIGH_WATER) / 2;
+    const unsigned long long messages_before = pipeline_message_total();
+    const auto start = steady_clock::now();
+    for (int round = 0; round < opt.repeat; ++round) {
+        for (const CapturedFrame& cf : frames) {
+            if (opt.pace) {
+                const double at_ns = static_cast<double>(round * span_ns + cf.offset_ns) / opt.speed;
+                std::this_thread::sleep_until(start + std::chrono::nanoseconds(static_cast<long long>(at_ns)));
+            } else {
+                while (frame_router_queue_depth() >= backlog_limit) {
+                    std::this_thread::yield();
+                }
+            }
+            frame_router_on_frame(cf.data, steady_clock::now());
+        }
+    }
+    const std::string ingress = frame_router_stats(); // 丢弃计数在入队时已确定，执行器停止后不再可查
+    frame_router_stop(); // 等各分片处理完已派发的消息
+    const double elapsed = std::chrono::duration<double>(steady_clock::now() - start).count();
+    const unsigned long long messages = pipeline_message_total() - messages_before;
+    const std::size_t throttled = outbound_scheduler_depth();
+    outbound_scheduler_stop();
+    ws_send_detach();
+
+    const unsigned long long total_frames = static_cast<unsigned long long>(frames.size()) * opt.repeat;
+    std::printf("replayed %llu frames (%llu group messages) from %s, %s, %d round(s)\n", total_frames, messages,
+        opt.path.c_str(), opt.pace ? "recorded pace" : "as fast as possible", opt.repeat);
+    std::printf("elapsed %.3fs: %.1f msgs/sec, %.1f frames/sec\n", elapsed,
+        static_cast<double>(messages) / elapsed, static_cast<double>(total_frames) / elapsed);
+    std::printf("per-message latency, us (log2 buckets: percentiles are bucket upper bounds)\n");
+    print_histogram("read -> handled", pipeline_histogram(PipelineStage::Handle));
+    for (PipelineStage stage : { PipelineStage::Parse, PipelineStage::Queue, PipelineStage::Normalize,
+             PipelineStage::Dispatch, PipelineStage::ReplyBuild, PipelineStage::Throttle }) {
+        print_histogram(pipeline_stage_name(stage), pipeline_histogram(stage));
+    }
+    std::printf("mock socket: %llu frames (%llu send_group_msg), %zu replies still throttled at exit\n",
+        socket.frames(), socket.group_msgs(), throttled);
+    std::printf("ingress: %s\n", ingress.c_str());
+    return 0;
+}
@@ -0,0 +1,118 @@
+﻿// 会话结束检查：在 WS_HOST:WS_PORT 上模拟 NapCat，握手后在不同时刻从服务端断开，
+// 确认 ws_session_run() 每次都能返回（否则重连监督器永远等不到会话结束，机器人一直离线）
+//
+// 断开时刻落在 API 期限清扫 / 看门狗定时器到期附近，使读失败与已到期的定时器回调在同一轮 io 中排队；
+// 交替使用 WebSocket 关闭帧与直接 RST 断开。任一轮在期限内未返回即打印并以非零退出
+//
+// 用法：qq-bot-session-check [--rounds N]（需先关闭占用该端口的 NapCat / mock）
+#include "config.h"
+#include "ws_session.h"
+#include <boost/asio.hpp>
+#include <boost/beast.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <string>
+#include <thread>
+
+namespace asio = boost::asio;
+namespace beast = boost::beast;
+namespace websocket = beast::websocket;
+using tcp = asio::ip::tcp;
+
+namespace {
+
+const std::chrono::seconds kReturnDeadline(2);
+
+// 第 round 轮握手后多久断开：依次贴近 RPC_SWEEP_INTERVAL_MS 的 1、2 倍与看门狗的 1 秒周期，前后各错开几毫秒
+std::chrono::milliseconds close_delay(int round)
+{
+    const int base = RPC_SWEEP_INTERVAL_MS * (1 + round % 2);
+    const int jitter = (round / 2) % 7 - 3;
+    return std::chrono::milliseconds(base + jitter);
+}
+
+// 接受一个连接，完成握手并发出一次心跳（让看门狗进入生效状态），到时后断开
+void serve_one(tcp::acceptor& acceptor, int round)
+{
+    tcp::socket socket(acceptor.get_executor());
+    acceptor.accept(socket);
+    websocket::stream<tcp::socket> ws(std::move(socket));
+    ws.accept();
+    ws.text(true);
+    ws.write(asio::buffer(std::string(
+        R"({"post_type":"meta_event","meta_event_type":"heartbeat","interval":5000,"status":{"online":true,"good":true}})")));
+    std::this_thread::sleep_for(close_delay(round));
+
+    beast::error_code ignored;
+    if (round % 3 == 2) {
+        ws.next_layer().set_option(asio::socket_base::linger(true, 0));
+        ws.next_layer().close(ignored);
+    } else {
+        ws.close(websocket::close_code::going_away, ignored);
+    }
+}
+
+bool parse_rounds(const char* text, int& rounds)
+{
+    char* end = nullptr;
+    const long value = std::strtol(text, &end, 10);
+    if (end == text || *end != '\0' || value <= 0) return false;
+    rounds = static_cast<int>(value);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int rounds = 28;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--rounds") == 0 && i + 1 < argc && parse_rounds(argv[i + 1], rounds)) {
+            ++i;
+        } else {
+            std::fprintf(stderr, "usage: %s [--rounds N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    asio::io_context ioc;
+    tcp::acceptor acceptor(ioc);
+    try {
+        const tcp::endpoint endpoint(asio::ip::make_address(WS_HOST), static_cast<unsigned short>(std::atoi(WS_PORT)));
+        acceptor.open(endpoint.protocol());
+        acceptor.set_option(asio::socket_base::reuse_address(true));
+        acceptor.bind(endpoint);
+        acceptor.listen();
+    }
+    catch (const beast::system_error& e) {
+        std::fprintf(stderr, "cannot listen on %s:%s: %s\n", WS_HOST, WS_PORT, e.what());
+        return 2;
+    }
+
+    for (int round = 0; round < rounds; ++round) {
+        auto session = std::async(std::launch::async, [] { return ws_session_run(); });
+        try {
+            serve_one(acceptor, round);
+        }
+        catch (const beast::system_error& e) {
+            std::fprintf(stderr, "round %d: server side failed: %s\n", round, e.what());
+            std::_Exit(1);
+        }
+        if (session.wait_for(kReturnDeadline) != std::future_status::ready) {
+            // 会话线程卡在 io_context::run() 里无法回收，直接退出
+            std::fprintf(stderr, "round %d: ws_session_run() did not return within %llds after the server closed (close after %lldms)\n",
+                round, static_cast<long long>(kReturnDeadline.count()), static_cast<long long>(close_delay(round).count()));
+            std::fflush(stderr);
+            std::_Exit(1);
+        }
+        if (!session.get().connected) {
+            std::fprintf(stderr, "round %d: session never completed the handshake\n", round);
+            return 1;
+        }
+    }
+    std::printf("session check passed: %d rounds, every session returned after the server closed\n", rounds);
+    return 0;
+}